@@ -10,11 +10,33 @@
 #include <thread>
 #include<functional>
 #include <chrono>
+#include <unordered_map>
+#include <atomic>
+#include <random>
+#include <fstream>
+#include <iomanip>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <coroutine>
+#include <utility>
+#include <memory_resource>
+#include <bit>
+#include <map>
+#include <filesystem>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define HAVE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
 using namespace std;
 using namespace sf;
 
 // -- ENUM FOR APP STATE --
-enum AppState { MENU, VIEW1, VIEW2, VIEW3, VIEW4 };
+enum AppState { MENU, VIEW1, VIEW2, VIEW3, VIEW4, VIEW5 };
 
 // -- STRUCTURES & CLASSES FROM YOUR DIJKSTRA VISUALIZER --
 struct Edge {
@@ -24,1365 +46,7441 @@ struct Edge {
     float flow = 0;      // Added for Ford-Fulkerson
 };
 
-class InputBox {
-public:
-    RectangleShape box;
-    Text inputText;
-    Font font;
-    string content;
+// -- SCENE SNAPSHOTS --
+// Views record what they draw into a Scene on the main thread and the render
+// thread replays finished scenes. A Scene owns copies of every drawable, so the
+// views are free to change while the previous frame is still being rendered.
+//
+// Fonts are the exception: sf::Font loads glyphs on demand into page textures
+// kept in a map, so a character or size seen for the first time changes the
+// font while the render thread may be reading it. Any glyph lookup and any
+// draw with a font's texture happens under glyphLock.
+mutex glyphLock;
+
+struct Scene {
+    enum Kind { TextItem, CircleItem, RectangleItem, SpriteItem, VertexItem, LayerItem };
+
+    struct Command {
+        Kind kind;
+        size_t index;
+        size_t count;
+        PrimitiveType type;
+        const Texture* texture = nullptr; // vertex items only
+    };
 
-    InputBox() {
-        font.loadFromFile("arial.ttf");
-        box.setSize(Vector2f(300, 30));
-        box.setFillColor(Color(200, 200, 200));
-        box.setPosition(20, 20);
+    // Static geometry recorded once; the renderer bakes it into a texture and
+    // bakes it again only when the version changes
+    struct Layer {
+        int id;
+        unsigned version;
+        shared_ptr<const Scene> scene;
+    };
 
-        inputText.setFont(font);
-        inputText.setCharacterSize(18);
-        inputText.setFillColor(Color::Black);
-        inputText.setPosition(25, 25);
+    // Copies stay allocated between frames so their vertex buffers are reused
+    template <typename T>
+    struct Pool {
+        vector<T> items;
+        size_t used = 0;
+
+        size_t add(const T& item) {
+            if (used < items.size()) items[used] = item;
+            else items.push_back(item);
+            return used++;
+        }
+    };
+
+    Vector2u size;
+    vector<Command> commands;
+    Pool<Text> texts;
+    Pool<CircleShape> circles;
+    Pool<RectangleShape> rectangles;
+    Pool<Sprite> sprites;
+    Pool<Layer> layers;
+    vector<Vertex> vertices;
+
+    void clear() {
+        commands.clear();
+        vertices.clear();
+        texts.used = circles.used = rectangles.used = sprites.used = layers.used = 0;
     }
 
-    void draw(RenderWindow& window) {
-        window.draw(box);
-        inputText.setString(content);
-        window.draw(inputText);
+    void record(const Text& text) {
+        // Lay out the glyphs here, so the render thread mostly finds them cached
+        lock_guard<mutex> guard(glyphLock);
+        text.getLocalBounds();
+        commands.push_back({ TextItem, texts.add(text), 1, Points });
     }
 
-    void addChar(char c) {
-        if (c == '\b' && !content.empty())
-            content.pop_back();
-        else if (c != '\b')
-            content += c;
+    void record(const CircleShape& circle) {
+        commands.push_back({ CircleItem, circles.add(circle), 1, Points });
     }
 
-    void clear() {
-        content.clear();
+    void record(const RectangleShape& rectangle) {
+        commands.push_back({ RectangleItem, rectangles.add(rectangle), 1, Points });
     }
-};
 
-class Graph {
-    RectangleShape exitButton;
-    Text exitButtonText;
-    RectangleShape restartButton;
-    Text restartButtonText;
-private:
-    struct Node {
-        Vector2f position;
-        CircleShape shape;
-        Text label;
-    };
+    void record(const Sprite& sprite) {
+        commands.push_back({ SpriteItem, sprites.add(sprite), 1, Points });
+    }
 
-    vector<Node> nodes;
-    vector<Edge> edges;
-    vector<Text> edgeLabels;
-    vector<Vertex> pathLines;
-    vector<int> shortestPath;
-    size_t animationIndex = 0;
-    bool animatePath = false;
+    void record(const Layer& layer) {
+        commands.push_back({ LayerItem, layers.add(layer), 1, Points });
+    }
 
-   CircleShape walker;
-   Font font;
-   Text instruction;
-   RectangleShape button;
-   Text buttonText;
+    void record(const Vertex* source, size_t count, PrimitiveType type, const Texture* texture = nullptr) {
+        if (count == 0) return;
+        commands.push_back({ VertexItem, vertices.size(), count, type, texture });
+        vertices.insert(vertices.end(), source, source + count);
+    }
+
+    void record(const VertexArray& array) {
+        if (array.getVertexCount() > 0)
+            record(&array[0], array.getVertexCount(), array.getPrimitiveType());
+    }
+};
 
+// Drawing surface handed to the views: records into a Scene and counts draw
+// calls for the HUD
+class Canvas {
+    Scene& scene;
 public:
-    Graph() {
-        font.loadFromFile("arial.ttf");
+    size_t drawCalls = 0;
 
-        instruction.setFont(font);
-        instruction.setCharacterSize(16);
-        instruction.setFillColor(Color::White);
-        instruction.setPosition(20, 60);
-        instruction.setString("Click to add nodes. Type edges as: from to weight");
+    explicit Canvas(Scene& scene) : scene(scene) {}
 
-        button.setSize({ 200, 40 });
-        button.setPosition(20, 520);
-        button.setFillColor(Color::White);
+    template <typename T>
+    void draw(const T& drawable) {
+        ++drawCalls;
+        scene.record(drawable);
+    }
 
-        buttonText.setFont(font);
-        buttonText.setCharacterSize(18);
-        buttonText.setFillColor(Color::Black);
-        buttonText.setString("Find Shortest Path");
-        buttonText.setPosition(30, 528);
+    void draw(const Vertex* vertices, size_t count, PrimitiveType type, const Texture* texture = nullptr) {
+        ++drawCalls;
+        scene.record(vertices, count, type, texture);
+    }
 
-        exitButton.setSize({ 150, 35 });
-        exitButton.setFillColor(Color(150, 0, 0));
-        exitButton.setPosition(650, 20);
+    Vector2u getSize() const {
+        return scene.size;
+    }
+};
 
-        exitButtonText.setFont(font);
-        exitButtonText.setCharacterSize(18);
-        exitButtonText.setFillColor(Color::White);
-        exitButtonText.setString("Exit");
-        exitButtonText.setPosition(680, 25);
+// -- TRACE EVENTS --
+// Scoped zones are recorded into per-thread ring buffers and written out as
+// Chrome trace-event JSON (chrome://tracing, Perfetto) on demand. Only the
+// owning thread writes a buffer; the dumper reads it without locking. Each
+// slot carries a sequence number (a seqlock), and the dumper drops any slot
+// that was being written or was overwritten while it was copying.
+struct TraceEvent {
+    const char* name; // string literal, never freed
+    long long startUs;
+    long long durationUs;
+    int tid;
+};
 
+class TraceBuffer {
+    // Event i sits in slot i % capacity; its sequence is odd while it is being
+    // written and 2 * i + 2 once it is complete. The fields are atomics so a
+    // read racing the writer is only stale, never undefined.
+    struct Slot {
+        atomic<unsigned long long> sequence{ 0 };
+        atomic<const char*> name{ nullptr };
+        atomic<long long> startUs{ 0 };
+        atomic<long long> durationUs{ 0 };
+        atomic<int> tid{ 0 };
+    };
 
-        walker.setRadius(8.f);
-        walker.setFillColor(Color::Yellow);
-        walker.setOrigin(8.f, 8.f);
-        //new code added
-        restartButton.setSize({ 150, 35 });
-        restartButton.setFillColor(Color::Blue);
-        restartButton.setPosition(470, 20);
+public:
+    static const size_t capacity = 1 << 14;
+    Slot slots[capacity];
+    atomic<unsigned long long> written{ 0 };
+    atomic<bool> inUse{ true };
+    TraceBuffer* next = nullptr;
+
+    void push(const TraceEvent& event) {
+        unsigned long long n = written.load(memory_order_relaxed);
+        Slot& slot = slots[n % capacity];
+        slot.sequence.store(2 * n + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release); // the odd sequence is seen before any new field
+        slot.name.store(event.name, memory_order_relaxed);
+        slot.startUs.store(event.startUs, memory_order_relaxed);
+        slot.durationUs.store(event.durationUs, memory_order_relaxed);
+        slot.tid.store(event.tid, memory_order_relaxed);
+        slot.sequence.store(2 * n + 2, memory_order_release);
+        written.store(n + 1, memory_order_release);
+    }
 
-        restartButtonText.setFont(font);
-        restartButtonText.setCharacterSize(18);
-        restartButtonText.setFillColor(Color::White);
-        restartButtonText.setString("Restart");
-        restartButtonText.setPosition(500, 25);
+    // Copies event i; false if it is not complete or was overwritten meanwhile
+    bool read(unsigned long long i, TraceEvent& out) const {
+        const Slot& slot = slots[i % capacity];
+        if (slot.sequence.load(memory_order_acquire) != 2 * i + 2) return false;
+        out.name = slot.name.load(memory_order_relaxed);
+        out.startUs = slot.startUs.load(memory_order_relaxed);
+        out.durationUs = slot.durationUs.load(memory_order_relaxed);
+        out.tid = slot.tid.load(memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire); // the fields are read before the check
+        return slot.sequence.load(memory_order_relaxed) == 2 * i + 2;
     }
-    void reset() {
-        nodes.clear();
-        edges.clear();
-        edgeLabels.clear();
-        pathLines.clear();
-        shortestPath.clear();
-        animationIndex = 0;
-        animatePath = false;
+};
+
+class TraceRecorder {
+    atomic<TraceBuffer*> head{ nullptr };
+    atomic<int> nextTid{ 1 };
+    chrono::steady_clock::time_point epoch = chrono::steady_clock::now();
+
+    // Returns a buffer to the pool when its thread exits; events are kept
+    struct ThreadSlot {
+        TraceBuffer* buffer = nullptr;
+        int tid = 0;
+        ~ThreadSlot() {
+            if (buffer) buffer->inUse.store(false, memory_order_release);
+        }
+    };
+
+    ThreadSlot& slot() {
+        thread_local ThreadSlot local;
+        if (!local.buffer) {
+            local.tid = nextTid++;
+            // Reuse a buffer left behind by a finished thread before allocating
+            for (TraceBuffer* b = head.load(memory_order_acquire); b; b = b->next) {
+                bool expected = false;
+                if (b->inUse.compare_exchange_strong(expected, true)) {
+                    local.buffer = b;
+                    return local;
+                }
+            }
+            TraceBuffer* b = new TraceBuffer();
+            b->next = head.load(memory_order_relaxed);
+            while (!head.compare_exchange_weak(b->next, b, memory_order_release, memory_order_relaxed)) {}
+            local.buffer = b;
+        }
+        return local;
     }
-    bool isRestartButtonClicked(Vector2f pos) {
-        return restartButton.getGlobalBounds().contains(pos);
+
+public:
+    long long nowUs() const {
+        return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - epoch).count();
     }
-    void draw(RenderWindow& window) {
-        for (size_t i = 0; i < edges.size(); i++) {
-            Vertex line[] = {
-                Vertex(nodes[edges[i].from].position, Color::White),
-                Vertex(nodes[edges[i].to].position,Color::White)
-            };
-            window.draw(line, 2, Lines);
-            window.draw(edgeLabels[i]);
-        }
 
-        if (!pathLines.empty())
-            window.draw(&pathLines[0], pathLines.size(),Lines);
+    void record(const char* name, long long startUs, long long durationUs) {
+        ThreadSlot& local = slot();
+        local.buffer->push({ name, startUs, durationUs, local.tid });
+    }
 
-        for (auto& node : nodes) {
-            window.draw(node.shape);
-            window.draw(node.label);
+    bool dump(const string& path) {
+        vector<TraceEvent> all;
+        for (TraceBuffer* b = head.load(memory_order_acquire); b; b = b->next) {
+            unsigned long long end = b->written.load(memory_order_acquire);
+            unsigned long long begin = end > TraceBuffer::capacity ? end - TraceBuffer::capacity : 0;
+            TraceEvent event;
+            for (unsigned long long i = begin; i < end; ++i)
+                if (b->read(i, event)) all.push_back(event);
         }
 
-        if (animatePath)
-            window.draw(walker);
+        ofstream out(path);
+        if (!out) return false;
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (size_t i = 0; i < all.size(); ++i) {
+            const TraceEvent& e = all[i];
+            out << (i ? ",\n" : "\n") << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid
+                << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs << "}";
+        }
+        out << "\n]}\n";
+        return true;
+    }
+};
 
-        window.draw(instruction);
-        window.draw(button);
-        window.draw(buttonText);
-        window.draw(exitButton);
-        window.draw(exitButtonText);
-        window.draw(restartButton);
-        window.draw(restartButtonText);
+TraceRecorder tracer;
 
+class TraceZone {
+    const char* name;
+    long long start;
+    bool open = true;
+public:
+    explicit TraceZone(const char* name) : name(name), start(tracer.nowUs()) {}
+    ~TraceZone() {
+        end();
     }
 
-    void addNode(Vector2f pos) {
-        Node node;
-        node.position = pos;
-        node.shape.setRadius(10);
-        node.shape.setFillColor(Color::Blue);
-        node.shape.setPosition(pos - Vector2f(10, 10));
+    // Closes the zone before the end of its scope
+    void end() {
+        if (!open) return;
+        open = false;
+        tracer.record(name, start, tracer.nowUs() - start);
+    }
 
-        node.label.setFont(font);
-        node.label.setCharacterSize(15);
-        node.label.setFillColor(Color::White);
-        node.label.setString(to_string(nodes.size()));
-        node.label.setPosition(pos.x - 5, pos.y - 20);
+    // Opens a new zone with the same name, closing the current one if needed
+    void restart() {
+        end();
+        open = true;
+        start = tracer.nowUs();
+    }
+};
 
-        nodes.push_back(node);
+const Color backgroundColor(30, 30, 30);
+
+// Geometry that only changes when the user edits the graph. It is recorded
+// again only after invalidate(); the render thread keeps it baked in an
+// off-screen texture and blits that each frame. The baked layer is opaque and
+// stands in for the window background, so text edges blend exactly as before.
+class StaticLayer {
+    int id;
+    unsigned version = 0;
+    shared_ptr<const Scene> recorded;
+    bool valid = false;
+
+    static int nextId() {
+        static atomic<int> counter(0);
+        return counter++;
     }
 
-    void addEdgeFromText(const string& str) {
-        istringstream iss(str);
-        int u, v;
-        float w;
-        if (iss >> u >> v >> w) {
-            edges.push_back({ u, v, w });
-            edges.push_back({ v, u, w });
+public:
+    StaticLayer() : id(nextId()) {}
 
-            Text label;
-            label.setFont(font);
-            label.setCharacterSize(15);
-            label.setFillColor(Color::Red);
-            Vector2f mid = (nodes[u].position + nodes[v].position) / 2.f;
-            label.setPosition(mid);
-            label.setString(to_string(static_cast<int>(w)));
-            edgeLabels.push_back(label);
-            edgeLabels.push_back(label);
+    void invalidate() {
+        valid = false;
+    }
+
+    template <typename Paint>
+    void draw(Canvas& window, Paint&& paint) {
+        if (!valid || recorded->size != window.getSize()) {
+            TraceZone zone("Static layer record");
+            shared_ptr<Scene> scene = make_shared<Scene>();
+            scene->size = window.getSize();
+            Canvas layer(*scene);
+            paint(layer);
+            recorded = scene;
+            ++version;
+            valid = true;
         }
+        window.draw(Scene::Layer{ id, version, recorded });
     }
+};
 
-    void handleClick(Vector2f pos) {
-        if (button.getGlobalBounds().contains(pos)) {
-            findShortestPath(0, nodes.size() - 1);
-            animatePath = true;
-            animationIndex = 0;
-            if (!shortestPath.empty())
-                walker.setPosition(nodes[shortestPath[0]].position);
+// -- ANIMATION TIME --
+// Animations read time from the timeline instead of a Clock. Live it follows
+// the wall clock; an export switches it to a fixed step that advances by one
+// frame period per rendered frame, so a recording plays at the same pace
+// however fast or slow the frames were produced.
+class Timeline {
+    Clock wall;
+    bool fixed = false;
+    Time fixedNow;
+public:
+    int stepsPerFrame = 1; // algorithm steps per frame while fixed
+
+    Time now() const {
+        return fixed ? fixedNow : wall.getElapsedTime();
+    }
+
+    bool isFixed() const {
+        return fixed;
+    }
+
+    void useFixedStep() {
+        fixedNow = now();
+        fixed = true;
+    }
+
+    void advance(Time step) {
+        fixedNow += step;
+    }
+};
+
+Timeline timeline;
+
+// Same interface as sf::Clock, on the timeline
+class AnimationClock {
+    Time started = timeline.now();
+public:
+    Time getElapsedTime() const {
+        return timeline.now() - started;
+    }
+
+    Time restart() {
+        Time now = timeline.now();
+        Time elapsed = now - started;
+        started = now;
+        return elapsed;
+    }
+};
+
+// -- NODE BATCHES --
+// Views keep nodes as slim records and draw all of them with two vertex
+// batches: discs cut from one shared texture and tinted per node, and the
+// node ids laid out straight from the font's glyph texture. That is two draw
+// calls however many nodes there are, instead of a shape and a text per node.
+AnimationClock pulseClock; // one clock drives every pulsing node
+
+class NodeBatch {
+    static const unsigned discSize = 64;
+    static constexpr float ringWidth = 1.f / 11; // of the outer radius, a 1 px outline at radius 10
+
+    const Font& font;
+    unsigned characterSize;
+    vector<Vertex> discs;
+    vector<Vertex> labels;
+
+    // A white disc on the left half and a white ring on the right, built once
+    static const Texture& discTexture() {
+        static Texture texture = [] {
+            Image image;
+            image.create(discSize * 2, discSize, Color::Transparent);
+            float r = discSize / 2.f;
+            for (unsigned y = 0; y < discSize; ++y) {
+                for (unsigned x = 0; x < discSize; ++x) {
+                    float d = hypot(x + 0.5f - r, y + 0.5f - r);
+                    float disc = max(0.f, min(1.f, r - d));
+                    float ring = min(disc, max(0.f, min(1.f, d - r * (1 - ringWidth))));
+                    image.setPixel(x, y, Color(255, 255, 255, static_cast<Uint8>(255 * disc)));
+                    image.setPixel(discSize + x, y, Color(255, 255, 255, static_cast<Uint8>(255 * ring)));
+                }
+            }
+            Texture built;
+            built.loadFromImage(image);
+            built.setSmooth(true);
+            return built;
+        }();
+        return texture;
+    }
+
+    static void addQuad(vector<Vertex>& out, FloatRect box, FloatRect source, Color color) {
+        Vector2f a(box.left, box.top), b(box.left + box.width, box.top);
+        Vector2f c(box.left, box.top + box.height), d(box.left + box.width, box.top + box.height);
+        Vector2f ta(source.left, source.top), tb(source.left + source.width, source.top);
+        Vector2f tc(source.left, source.top + source.height), td(source.left + source.width, source.top + source.height);
+        out.push_back(Vertex(a, color, ta));
+        out.push_back(Vertex(b, color, tb));
+        out.push_back(Vertex(c, color, tc));
+        out.push_back(Vertex(c, color, tc));
+        out.push_back(Vertex(b, color, tb));
+        out.push_back(Vertex(d, color, td));
+    }
+
+public:
+    NodeBatch(const Font& font, unsigned characterSize) : font(font), characterSize(characterSize) {}
+
+    // Vertex buffers keep their capacity for the next rebuild
+    void clear() {
+        discs.clear();
+        labels.clear();
+    }
+
+    // A circle like CircleShape at center, with an optional 1 px outline
+    void addDisc(Vector2f center, float radius, Color fill, Color outline = Color::Transparent) {
+        float size = static_cast<float>(discSize);
+        addQuad(discs, FloatRect(center.x - radius, center.y - radius, 2 * radius, 2 * radius),
+            FloatRect(0, 0, size, size), fill);
+        if (outline.a > 0) {
+            float outer = radius + 1;
+            addQuad(discs, FloatRect(center.x - outer, center.y - outer, 2 * outer, 2 * outer),
+                FloatRect(size, 0, size, size), outline);
         }
-        else {
-            addNode(pos);
+    }
+
+    // Lays text out the way sf::Text does with its origin at position, or
+    // with its bounds centred on position
+    void addLabel(const string& text, Vector2f position, Color color, bool centered = false) {
+        size_t first = labels.size();
+        float x = 0, y = static_cast<float>(characterSize);
+        float minX = y, minY = y, maxX = 0, maxY = 0;
+        const float padding = 1; // same margin sf::Text samples around each glyph
+        lock_guard<mutex> guard(glyphLock);
+        for (char c : text) {
+            const Glyph& glyph = font.getGlyph(static_cast<Uint8>(c), characterSize, false);
+            FloatRect b = glyph.bounds;
+            IntRect t = glyph.textureRect;
+            addQuad(labels, FloatRect(position.x + x + b.left - padding, position.y + y + b.top - padding,
+                b.width + 2 * padding, b.height + 2 * padding),
+                FloatRect(t.left - padding, t.top - padding, t.width + 2 * padding, t.height + 2 * padding), color);
+            minX = min(minX, x + b.left);
+            maxX = max(maxX, x + b.left + b.width);
+            minY = min(minY, y + b.top);
+            maxY = max(maxY, y + b.top + b.height);
+            x += glyph.advance;
         }
+        if (!centered || text.empty()) return;
+        Vector2f shift(-(maxX - minX) / 2, -(maxY - minY) / 2);
+        for (size_t i = first; i < labels.size(); ++i)
+            labels[i].position += shift;
     }
 
-    void update() {
-        if (animatePath && animationIndex < shortestPath.size() - 1) {
-            Vector2f current = walker.getPosition();
-            Vector2f target = nodes[shortestPath[animationIndex + 1]].position;
-            Vector2f dir = target - current;
-            float dist = sqrt(dir.x * dir.x + dir.y * dir.y);
-            if (dist > 1.5f) {
-                dir /= dist;
-                walker.move(dir * 2.f);
-            }
-            else {
-                walker.setPosition(target);
-                animationIndex++;
-            }
+    void draw(Canvas& canvas) const {
+        if (!discs.empty())
+            canvas.draw(discs.data(), discs.size(), Triangles, &discTexture());
+        if (!labels.empty()) {
+            lock_guard<mutex> guard(glyphLock);
+            canvas.draw(labels.data(), labels.size(), Triangles, &font.getTexture(characterSize));
         }
     }
+};
 
-    void findShortestPath(int start, int end) {
-        int n = nodes.size();
-        vector<float> dist(n, numeric_limits<float>::max());
-        vector<int> parent(n, -1);
-        dist[start] = 0;
-        using P = pair<float, int>;
-        priority_queue<P, vector<P>, greater<P>> pq;
-        pq.push({ 0, start });
+// -- RENDER THREAD --
+// Replays recorded scenes into a render target. Static layers are baked into
+// off-screen textures that are kept, per layer, until its version changes.
+// Must be used from the thread whose GL context is current.
+class SceneRenderer {
+    struct BakedLayer {
+        unique_ptr<RenderTexture> texture;
+        Sprite sprite;
+        unsigned version = 0;
+        bool usable = true;
+    };
 
-        while (!pq.empty()) {
-            int u = pq.top().second;
-            float d = pq.top().first;
-            pq.pop();
-            if (d > dist[u]) continue;
-            for (const auto& edge : edges) {
-                if (edge.from == u) {
-                    int v = edge.to;
-                    float w = edge.weight;
-                    if (dist[u] + w < dist[v]) {
-                        dist[v] = dist[u] + w;
-                        parent[v] = u;
-                        pq.push({ dist[v], v });
-                    }
+    unordered_map<int, BakedLayer> bakedLayers;
+
+public:
+    void draw(const Scene& scene, RenderTarget& target) {
+        for (const Scene::Command& command : scene.commands) {
+            switch (command.kind) {
+            case Scene::TextItem: {
+                lock_guard<mutex> guard(glyphLock);
+                target.draw(scene.texts.items[command.index]);
+                break;
+            }
+            case Scene::CircleItem:
+                target.draw(scene.circles.items[command.index]);
+                break;
+            case Scene::RectangleItem:
+                target.draw(scene.rectangles.items[command.index]);
+                break;
+            case Scene::SpriteItem:
+                target.draw(scene.sprites.items[command.index]);
+                break;
+            case Scene::VertexItem:
+                if (command.texture) {
+                    // Textured batches may be cut from a font's glyph page
+                    lock_guard<mutex> guard(glyphLock);
+                    target.draw(&scene.vertices[command.index], command.count, command.type, RenderStates(command.texture));
                 }
+                else
+                    target.draw(&scene.vertices[command.index], command.count, command.type);
+                break;
+            case Scene::LayerItem:
+                drawLayer(scene.layers.items[command.index], target);
+                break;
             }
         }
+    }
 
-        shortestPath.clear();
-        for (int v = end; v != -1; v = parent[v])
-            shortestPath.push_back(v);
-        reverse(shortestPath.begin(), shortestPath.end());
+    // Releases the baked textures; call while the context is still current
+    void clear() {
+        bakedLayers.clear();
+    }
 
-        pathLines.clear();
-        for (size_t i = 1; i < shortestPath.size(); ++i) {
-            pathLines.push_back(Vertex(nodes[shortestPath[i - 1]].position, Color::Cyan));
-            pathLines.push_back(Vertex(nodes[shortestPath[i]].position, Color::Cyan));
+private:
+    void drawLayer(const Scene::Layer& layer, RenderTarget& target) {
+        BakedLayer& baked = bakedLayers[layer.id];
+        Vector2u size = layer.scene->size;
+        if (baked.usable && (!baked.texture || baked.texture->getSize() != size)) {
+            baked.texture.reset(new RenderTexture);
+            baked.usable = baked.texture->create(size.x, size.y);
+            baked.version = 0;
         }
-    }
-    bool isExitButtonClicked(Vector2f pos) {
-        return exitButton.getGlobalBounds().contains(pos);
+        if (!baked.usable) {
+            // No off-screen support: replay the layer straight into the target
+            draw(*layer.scene, target);
+            return;
+        }
+        if (baked.version != layer.version) {
+            TraceZone zone("Static layer bake");
+            baked.texture->clear(backgroundColor);
+            draw(*layer.scene, *baked.texture);
+            baked.texture->display();
+            baked.sprite.setTexture(baked.texture->getTexture(), true);
+            baked.version = layer.version;
+        }
+        target.draw(baked.sprite);
     }
 };
 
-//A* algorithm 
-struct Cell {
-    int row, col;
-    bool isWall = false;
-    bool isVisited = false;
-    bool isPath = false;
-    float g = INFINITY, h = 0;
-    Cell* parent = nullptr;
-};
+// Owns the window's GL context and draws the newest submitted scene. The main
+// thread records into one scene while this thread draws another; a third slot
+// hands finished scenes over, so neither side waits for the other. A frame the
+// renderer never got to is simply replaced by the next one.
+class RenderThread {
+    RenderWindow& window;
+    unique_ptr<Scene> back, pending, front;
+    bool hasPending = false;
+    bool stopping = false;
+    mutex lock;
+    condition_variable wake;
+    thread worker;
+    SceneRenderer painter; // render thread only
 
-class AStarVisualizer {
-private:
-    const int rows = 50;
-    const int cols = 80;
-    const int cellSize = 30;
-    vector<vector<Cell>> grid;
-    Cell* start = nullptr;
-    Cell* end = nullptr;
-    bool running = false;
-    bool pathFound = false;
-    //new member variable for reset buuton
-    RectangleShape restartButton;
-    Text restartButtonText;
-    RectangleShape exitbutton;
-    Text exitbuttonText;
-    Font font;
 public:
-    AStarVisualizer() {
-        grid.resize(rows, vector<Cell>(cols));
-        for (int r = 0; r < rows; ++r)
-            for (int c = 0; c < cols; ++c)
-                grid[r][c] = { r, c };
-
-        font.loadFromFile("arial.ttf");
-        restartButton.setSize({ 150, 35 });
-        restartButton.setFillColor(Color::Blue);
-        restartButton.setPosition(700, 20);
-
-        restartButtonText.setFont(font);
-        restartButtonText.setCharacterSize(18);
-        restartButtonText.setFillColor(Color::White);
-        restartButtonText.setString("Restart");
-        restartButtonText.setPosition(730, 25);
+    explicit RenderThread(RenderWindow& window)
+        : window(window), back(new Scene), pending(new Scene), front(new Scene) {}
 
-        exitbutton.setSize({ 150, 35 });
-        exitbutton.setFillColor(Color::Red);
-        exitbutton.setPosition(1025, 20);
+    ~RenderThread() {
+        stop();
+    }
 
-        exitbuttonText.setFont(font);
-        exitbuttonText.setCharacterSize(18);
-        exitbuttonText.setFillColor(Color::White);
-        exitbuttonText.setString("Exit");
-        exitbuttonText.setPosition(1040, 25);
+    void start() {
+        window.setActive(false); // the context moves to the render thread
+        worker = thread(&RenderThread::run, this);
     }
 
-    void reset() {
-        for (int r = 0; r < rows; ++r) {
-            for (int c = 0; c < cols; ++c) {
-                grid[r][c] = { r, c }; 
-            }
+    // Must be called before the window is closed
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
         }
-        start = nullptr;
-        end = nullptr;
-        running = false;
-        pathFound = false;
+        wake.notify_one();
+        worker.join();
     }
 
-    bool isRestartButtonClicked(Vector2f pos) {
-        return restartButton.getGlobalBounds().contains(pos);
+    // Scene for the main thread to record the next frame into
+    Scene& beginFrame() {
+        back->clear();
+        back->size = window.getSize();
+        return *back;
     }
 
-    bool isExitButtonClicked(Vector2f pos) {
-        return exitbutton.getGlobalBounds().contains(pos);
+    void submit() {
+        {
+            lock_guard<mutex> guard(lock);
+            swap(back, pending);
+            hasPending = true;
+        }
+        wake.notify_one();
     }
 
-    void draw(RenderWindow& window) {
-        for (int r = 0; r < rows; ++r) {
-            for (int c = 0; c < cols; ++c) {
-                Cell& cell = grid[r][c];
-                RectangleShape rect(Vector2f(cellSize - 1, cellSize - 1));
-                rect.setPosition(c * cellSize, r * cellSize);
-
-                if (&cell == start) rect.setFillColor(Color::Green);
-                else if (&cell == end) rect.setFillColor(Color::Red);
-                else if (cell.isWall) rect.setFillColor(Color(50, 50, 50));
-                else if (cell.isPath) rect.setFillColor(Color::Yellow);
-                else if (cell.isVisited) rect.setFillColor(Color(100, 100, 255));
-                else rect.setFillColor(Color::White);
-
-                window.draw(rect);
+private:
+    void run() {
+        window.setActive(true);
+        while (true) {
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [this] { return hasPending || stopping; });
+                if (stopping) break;
+                swap(front, pending);
+                hasPending = false;
             }
-        }
-        window.draw(restartButton);
-        window.draw(restartButtonText);
-        window.draw(exitbutton);
-        window.draw(exitbuttonText);
-    }
 
+            TraceZone renderZone("Render");
+            window.clear(backgroundColor);
+            painter.draw(*front, window);
+            renderZone.end();
 
-    void handleClick(Vector2f pos) {
-        int row = pos.y / cellSize;
-        int col = pos.x / cellSize;
-        if (row >= 0 && row < rows && col >= 0 && col < cols) {
-            Cell* clicked = &grid[row][col];
-            if (Mouse::isButtonPressed(Mouse::Left)) {
-                if (!start) start = clicked;
-                else if (!end && clicked != start) end = clicked;
-                else if (clicked != start && clicked != end) clicked->isWall = !clicked->isWall;
-            }
-            else if (Mouse::isButtonPressed(Mouse::Right)) {
-                if (clicked == start) start = nullptr;
-                if (clicked == end) end = nullptr;
-                clicked->isWall = false;
-            }
+            TraceZone displayZone("Display");
+            window.display();
         }
+        painter.clear(); // release the textures while the context is current
+        window.setActive(false);
     }
+};
 
-    void runAStar() {
-        struct Node {
-            Cell* cell;
-            float f;
-            bool operator>(const Node& other) const { return f > other.f; }
-        };
+// Operation counts of the algorithm run in progress; the hooks are plain
+// increments into the counters of whichever thread runs the algorithm
+struct AlgorithmCounters {
+    long long heapPushes = 0;
+    long long relaxations = 0;
+    long long expansions = 0;
+    long long augmentingPaths = 0;
+    long long scratchAllocations = 0; // served by the view's scratch arena
+    long long heapAllocations = 0;    // arena blocks that had to come from the heap
+};
 
-        priority_queue<Node, vector<Node>, greater<Node>> openSet;
-        start->g = 0;
-        start->h = heuristic(start, end);
-        openSet.push({ start, start->h });
+struct RunStats {
+    string algorithm;
+    double wallMs = 0;
+    AlgorithmCounters counters;
+};
 
-        while (!openSet.empty()) {
-            Cell* current = openSet.top().cell;
-            openSet.pop();
+thread_local AlgorithmCounters perf;
+mutex lastRunLock;
+RunStats lastRun;
+thread_local RunStats lastRunOnThread; // for jobs that time several runs
 
-            if (current == end) {
-                Cell* p = end;
-                while (p) {
-                    p->isPath = true;
-                    p = p->parent;
-                }
-                pathFound = true;
-                return;
-            }
+RunStats latestRun() {
+    lock_guard<mutex> guard(lastRunLock);
+    return lastRun;
+}
 
-            current->isVisited = true;
+// Times one algorithm run, traces it as a zone, and publishes its counters to
+// the HUD when it ends
+class ScopedRun {
+    const char* algorithm;
+    chrono::steady_clock::time_point begin;
+    chrono::steady_clock::duration active{};
+    AlgorithmCounters saved;
+    bool paused = false;
+    TraceZone zone;
+public:
+    explicit ScopedRun(const char* algorithm) : algorithm(algorithm), begin(chrono::steady_clock::now()), zone(algorithm) {
+        perf = AlgorithmCounters();
+    }
 
-            for (auto neighbor : neighbors(current)) {
-                float tentativeGScore = current->g + 1; // Distance between neighbors is 1
-                if (tentativeGScore < neighbor->g) {
-                    neighbor->parent = current;
-                    neighbor->g = tentativeGScore;
-                    neighbor->h = heuristic(neighbor, end);
-                    openSet.push({ neighbor, neighbor->g + neighbor->h });
-                }
-            }
+    ~ScopedRun() {
+        if (!paused) {
+            active += chrono::steady_clock::now() - begin;
+            saved = perf;
         }
+        lastRunOnThread.algorithm = algorithm;
+        lastRunOnThread.wallMs = chrono::duration<double, milli>(active).count();
+        lastRunOnThread.counters = saved;
+        lock_guard<mutex> guard(lastRunLock);
+        lastRun = lastRunOnThread;
     }
 
-private:
-    float heuristic(Cell* a, Cell* b) {
-        return abs(a->row - b->row) + abs(a->col - b->col); // Manhattan distance
+    // A generator suspended between frames: neither the time nor the counts
+    // of whatever runs meanwhile belong to this run
+    void pause() {
+        active += chrono::steady_clock::now() - begin;
+        saved = perf;
+        paused = true;
+        zone.end();
     }
 
-    vector<Cell*> neighbors(Cell* cell) {
-        vector<Cell*> result;
+    void resume() {
+        begin = chrono::steady_clock::now();
+        perf = saved;
+        paused = false;
+        zone.restart();
+    }
+};
 
-        int dr[] = { -1, 1, 0, 0 };
-        int dc[] = { 0, 0, -1, 1 };
+// -- BACKGROUND JOBS --
+// Runs that are not animated step by step execute on a small worker pool
+// against a copy of the view's data. A run polls its CancelToken in its main loop and reports progress
+// through it; the view holds a BackgroundRun handle and polls it once per
+// frame. The result is published with a single release store, so handing it
+// back to the UI thread takes no lock.
+class CancelToken {
+    const atomic<bool>* cancelled = nullptr;
+    atomic<float>* progress = nullptr;
+public:
+    CancelToken() = default; // never cancelled, for synchronous callers
 
-        for (int i = 0; i < 4; ++i) {
-            int nr = cell->row + dr[i];
-            int nc = cell->col + dc[i];
-            if (nr >= 0 && nr < rows && nc >= 0 && nc < cols && !grid[nr][nc].isWall)
-                result.push_back(&grid[nr][nc]);
-        }
+    CancelToken(const atomic<bool>& cancelled, atomic<float>& progress) : cancelled(&cancelled), progress(&progress) {}
 
-        return result;
+    bool isCancelled() const {
+        return cancelled && cancelled->load(memory_order_relaxed);
+    }
+
+    void report(float fraction) const {
+        if (progress) progress->store(fraction, memory_order_relaxed);
     }
 };
 
-// -- FORD FULKERSON IMPLEMENTATION --
-class FordFulkersonVisualizer {
-    RectangleShape restartButton;
-    Text restartButtonText;
+class WorkerPool {
+    vector<thread> threads;
+    queue<function<void()>> jobs;
+    mutex lock;
+    condition_variable wake;
+    bool stopping = false;
 
-private:
-    struct Node {
-        Vector2f position;
-        CircleShape shape;
-        Text label;
-    };
+public:
+    explicit WorkerPool(unsigned count) {
+        for (unsigned i = 0; i < count; ++i)
+            threads.emplace_back([this] { work(); });
+    }
 
-    vector<Node> nodes;
-    vector<Edge> edges;
-    Font font;
+    // Queued jobs are dropped; a job already running finishes or notices its
+    // cancellation first
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (thread& t : threads)
+            t.join();
+    }
 
-    RectangleShape button;
-    Text buttonText;
-    Text instructionText;
-    Text maxFlowText;
-    Text inputPrompt;
-    Text inputText;
-    RectangleShape exitButton;
-    Text exitButtonText;
+    void submit(function<void()> job) {
+        {
+            lock_guard<mutex> guard(lock);
+            jobs.push(move(job));
+        }
+        wake.notify_one();
+    }
 
-    string userInput;
+    size_t size() const {
+        return threads.size();
+    }
 
-    bool animating = false;
-    vector<int> currentPath;
-    size_t animationIndex = 0;
-    CircleShape walker;
+private:
+    void work() {
+        while (true) {
+            function<void()> job;
+            {
+                unique_lock<mutex> guard(lock);
+                wake.wait(guard, [this] { return stopping || !jobs.empty(); });
+                if (stopping) return;
+                job = move(jobs.front());
+                jobs.pop();
+            }
+            job();
+        }
+    }
+};
 
-    float totalFlow = 0;
+WorkerPool workers(max(2u, thread::hardware_concurrency()) - 1);
+
+// Runs body(begin, end) over [0, count) in chunks shared by the calling thread
+// and any idle workers. The caller only waits for chunks a worker has already
+// claimed, so a long job holding the pool just leaves it more chunks to do.
+void parallelFor(size_t count, size_t chunkSize, const function<void(size_t, size_t)>& body) {
+    struct Shared {
+        atomic<size_t> next{ 0 };
+        atomic<size_t> done{ 0 };
+        size_t chunks = 0;
+        size_t count = 0;
+        size_t chunkSize = 0;
+        const function<void(size_t, size_t)>* body = nullptr;
+        mutex lock;
+        condition_variable finished;
+
+        // Claims chunks until none are left; only touches body while one is claimed
+        void drain() {
+            for (size_t c; (c = next.fetch_add(1)) < chunks;) {
+                (*body)(c * chunkSize, min(count, (c + 1) * chunkSize));
+                if (done.fetch_add(1) + 1 == chunks) {
+                    lock_guard<mutex> guard(lock);
+                    finished.notify_all();
+                }
+            }
+        }
+    };
+
+    auto shared = make_shared<Shared>();
+    shared->count = count;
+    shared->chunkSize = max<size_t>(1, chunkSize);
+    shared->chunks = (count + shared->chunkSize - 1) / shared->chunkSize;
+    shared->body = &body;
+    for (size_t i = 1; i < min(shared->chunks, workers.size() + 1); ++i)
+        workers.submit([shared] { shared->drain(); });
+    shared->drain();
+    unique_lock<mutex> guard(shared->lock);
+    shared->finished.wait(guard, [&] { return shared->done.load() == shared->chunks; });
+}
 
-    RenderWindow* renderWindow = nullptr; // For animation
+// One cancellable run whose result type is Result. Starting a new run or
+// cancelling abandons the previous one at once; the worker stops at its next
+// cancellation check and its result is discarded.
+template <typename Result>
+class BackgroundRun {
+    struct State {
+        atomic<bool> cancelled{ false };
+        atomic<bool> done{ false };
+        atomic<float> progress{ 0.f };
+        Result result;
+    };
+    shared_ptr<State> state;
 
 public:
-    FordFulkersonVisualizer() {
-        font.loadFromFile("arial.ttf");
+    ~BackgroundRun() {
+        cancel();
+    }
 
-        button.setSize(Vector2f(180, 35));
-        button.setFillColor(Color::Green);
-        button.setPosition(600, 35);
+    // work(const CancelToken&) returns the Result; it must only use data it owns
+    template <typename Work>
+    void start(Work work) {
+        cancel();
+        shared_ptr<State> job = make_shared<State>();
+        state = job;
+        workers.submit([job, work]() mutable {
+            if (job->cancelled.load(memory_order_relaxed)) return;
+            CancelToken token(job->cancelled, job->progress);
+            job->result = work(token);
+            job->done.store(true, memory_order_release);
+        });
+    }
 
-        buttonText.setFont(font);
-        buttonText.setString("Find Max Flow");
-        buttonText.setCharacterSize(18);
-        buttonText.setFillColor(Color::White);
-        buttonText.setPosition(610, 40);
+    void cancel() {
+        if (!state) return;
+        state->cancelled.store(true, memory_order_relaxed);
+        state.reset();
+    }
 
-        instructionText.setFont(font);
-        instructionText.setCharacterSize(20);
-        instructionText.setFillColor(Color::Yellow);
-        instructionText.setPosition(20, 10);
-        instructionText.setString("Click to add nodes. Type edges as: from to capacity.");
+    bool isRunning() const {
+        return state != nullptr;
+    }
 
-        inputPrompt.setFont(font);
-        inputPrompt.setCharacterSize(20);
-        inputPrompt.setFillColor(Color::Yellow);
-        inputPrompt.setPosition(20, 520);
-        inputPrompt.setString("Edge Input (e.g. 0 1 10):");
+    float progress() const {
+        return state ? state->progress.load(memory_order_relaxed) : 0.f;
+    }
 
-        inputText.setFont(font);
-        inputText.setCharacterSize(20);
-        inputText.setFillColor(Color::White);
-        inputText.setPosition(250, 520);
+    // Moves the result out once the worker has published it
+    bool poll(Result& out) {
+        if (!state || !state->done.load(memory_order_acquire)) return false;
+        out = move(state->result);
+        state.reset();
+        return true;
+    }
+};
 
-        maxFlowText.setFont(font);
-        maxFlowText.setCharacterSize(20);
-        maxFlowText.setFillColor(Color::White);
-        maxFlowText.setPosition(20, 550);
+// -- STEP GENERATORS --
+// Animated algorithms are written once as coroutines that yield one step
+// event at a time. Views pull steps as they need them, either one per
+// animation tick or as many as fit into stepBudget per frame, so a run shows
+// progress at once and nothing is precomputed or buffered. Destroying the
+// generator cancels the run.
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        T current{};
 
-        exitButton.setSize({ 150, 35 });
-        exitButton.setFillColor(Color(150, 0, 0));
-        exitButton.setPosition(830,35);
+        Generator get_return_object() {
+            return Generator(coroutine_handle<promise_type>::from_promise(*this));
+        }
+        suspend_always initial_suspend() noexcept { return {}; }
+        suspend_always final_suspend() noexcept { return {}; }
+        // Copied into a value that lives as long as the generator, so a step
+        // holding containers reuses their capacity instead of reallocating
+        suspend_always yield_value(const T& value) {
+            current = value;
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { throw; }
+    };
 
-        exitButtonText.setFont(font);
-        exitButtonText.setCharacterSize(18);
-        exitButtonText.setFillColor(Color::White);
-        exitButtonText.setString("Exit");
-        exitButtonText.setPosition(850, 40);
+    Generator() = default;
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
 
-        walker.setRadius(8);
-        walker.setFillColor(Color::Cyan);
-        walker.setOrigin(8, 8);
-        //new constructor element is added
-        restartButton.setSize({ 150, 35 });
-        restartButton.setFillColor(Color::Blue);
-        restartButton.setPosition(420, 35);
+    Generator(Generator&& other) noexcept : handle(exchange(other.handle, {})) {}
 
-        restartButtonText.setFont(font);
-        restartButtonText.setCharacterSize(18);
-        restartButtonText.setFillColor(Color::White);
-        restartButtonText.setString("Restart");
-        restartButtonText.setPosition(480, 40);
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            reset();
+            handle = exchange(other.handle, {});
+        }
+        return *this;
     }
 
-    //new code added
+    ~Generator() {
+        reset();
+    }
 
-    void reset() {
-        nodes.clear();
-        edges.clear();
-        userInput.clear();
-        animating = false;
-        totalFlow = 0;
-        currentPath.clear();
-        maxFlowText.setString("");
+    bool isRunning() const {
+        return handle && !handle.done();
     }
 
-    void setRenderWindow(RenderWindow& win) {
-        renderWindow = &win;
+    // Runs the algorithm up to its next step; false once it has finished
+    bool next() {
+        if (!isRunning()) return false;
+        handle.resume();
+        return !handle.done();
     }
 
-    bool isAnimating() const {
-        return animating;
+    const T& value() const {
+        return handle.promise().current;
     }
 
-    bool isExitButtonClicked(Vector2f pos) {
-        return exitButton.getGlobalBounds().contains(pos);
+    void reset() {
+        if (handle) handle.destroy();
+        handle = {};
     }
 
-    void handleClick(Vector2f pos) {
-        if (button.getGlobalBounds().contains(pos)) {
-            if (!animating)
-                startMaxFlow();
-            return;
-        }
+private:
+    explicit Generator(coroutine_handle<promise_type> handle) : handle(handle) {}
 
-        if (isExitButtonClicked(pos)) {
-            return; // Exit will be handled by the main code
-        }
+    coroutine_handle<promise_type> handle;
+};
 
-        addNode(pos.x, pos.y);
+const Time stepBudget = milliseconds(4);
+
+// Work allowed per frame: stepBudget of wall time live, a fixed number of
+// steps on a fixed timeline so an export renders the same frames every time
+class FrameBudget {
+    Clock clock;
+    int steps = 0;
+public:
+    // Call after each unit of work
+    bool spent() {
+        if (timeline.isFixed()) return ++steps >= timeline.stepsPerFrame;
+        return clock.getElapsedTime() >= stepBudget;
     }
+};
 
-    void addNode(float x, float y) {
-        CircleShape circle(15);
-        circle.setFillColor(Color::Blue);
-        circle.setPosition(x - 15, y - 15);
+// Feeds steps to onStep until the frame's budget is spent, at least one;
+// false once the generator is exhausted
+template <typename T, typename OnStep>
+bool pumpSteps(Generator<T>& steps, OnStep&& onStep) {
+    FrameBudget budget;
+    do {
+        if (!steps.next()) return false;
+        onStep(steps.value());
+    } while (!budget.spent());
+    return true;
+}
 
-        Text label;
-        label.setFont(font);
-        label.setString(to_string(nodes.size()));
-        label.setCharacterSize(14);
-        label.setFillColor(Color::White);
-        label.setPosition(x - 5, y - 30);
+// -- SCRATCH MEMORY --
+// Each view owns an arena for the scratch data of its runs. Resetting it at
+// the start of a run frees everything the previous run allocated in one step.
+// The arena keeps its block between runs and grows it to fit the largest run
+// seen so far, so once warmed up a run never reaches the heap. Both kinds of
+// allocation are counted for the HUD.
+class ScratchArena {
+    // Forwards to another resource, counting each allocation in perf
+    class CountingResource : public pmr::memory_resource {
+        long long AlgorithmCounters::* counter;
+    public:
+        pmr::memory_resource* next;
+        size_t bytes = 0;
+
+        CountingResource(pmr::memory_resource* next, long long AlgorithmCounters::* counter) : counter(counter), next(next) {}
+
+    private:
+        void* do_allocate(size_t size, size_t alignment) override {
+            ++(perf.*counter);
+            bytes += size;
+            return next->allocate(size, alignment);
+        }
 
-        nodes.push_back({ {x, y}, circle, label });
-    }
+        void do_deallocate(void* p, size_t size, size_t alignment) override {
+            next->deallocate(p, size, alignment);
+        }
 
-    void addEdge(int from, int to, float capacity) {
-        if (from >= 0 && from < nodes.size() && to >= 0 && to < nodes.size()) {
-            edges.push_back({ from, to, 0, capacity, 0 }); // weight=0 for FF
-            edges.push_back({ to, from, 0, 0, 0 });       // reverse edge with zero capacity
+        bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    vector<char> block;
+    CountingResource heap{ pmr::new_delete_resource(), &AlgorithmCounters::heapAllocations };
+    unique_ptr<pmr::monotonic_buffer_resource> arena;
+    CountingResource front{ nullptr, &AlgorithmCounters::scratchAllocations };
+
+public:
+    // Everything allocated since the previous reset must be gone by now
+    pmr::memory_resource* reset() {
+        if (heap.bytes > 0) {
+            arena.reset(); // returns the overflow blocks before the block grows
+            block.resize(block.size() + heap.bytes);
+            heap.bytes = 0;
         }
+        if (block.empty())
+            arena.reset(new pmr::monotonic_buffer_resource(&heap));
+        else
+            arena.reset(new pmr::monotonic_buffer_resource(block.data(), block.size(), &heap));
+        front.next = arena.get();
+        return &front;
     }
+};
 
-    void handleTextInput(Uint32 unicode) {
-        if (unicode == 8 && !userInput.empty()) {
-            userInput.pop_back();
+// -- VECTOR KERNELS --
+// Index of the smallest value, the first one on ties, -1 if there is none.
+// One pass takes the minimum eight (AVX2) or four (SSE2) lanes at a time and
+// a second finds where it first occurs; builds without either scan scalar.
+inline int argmin(const float* values, int count) {
+    if (count <= 0) return -1;
+    int i = 0;
+    float best = values[0];
+#if defined(HAVE_AVX2)
+    if (count >= 8) {
+        __m256 lanes = _mm256_loadu_ps(values);
+        for (i = 8; i + 8 <= count; i += 8)
+            lanes = _mm256_min_ps(lanes, _mm256_loadu_ps(values + i));
+        alignas(32) float lane[8];
+        _mm256_store_ps(lane, lanes);
+        best = *min_element(lane, lane + 8);
+    }
+#elif defined(HAVE_SSE2)
+    if (count >= 4) {
+        __m128 lanes = _mm_loadu_ps(values);
+        for (i = 4; i + 4 <= count; i += 4)
+            lanes = _mm_min_ps(lanes, _mm_loadu_ps(values + i));
+        alignas(16) float lane[4];
+        _mm_store_ps(lane, lanes);
+        best = *min_element(lane, lane + 4);
+    }
+#endif
+    for (; i < count; ++i)
+        best = min(best, values[i]);
+
+    i = 0;
+#if defined(HAVE_AVX2)
+    __m256 target = _mm256_set1_ps(best);
+    for (; i + 8 <= count; i += 8) {
+        unsigned mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(values + i), target, _CMP_EQ_OQ));
+        if (mask) return i + countr_zero(mask);
+    }
+#elif defined(HAVE_SSE2)
+    __m128 target = _mm_set1_ps(best);
+    for (; i + 4 <= count; i += 4) {
+        unsigned mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(values + i), target));
+        if (mask) return i + countr_zero(mask);
+    }
+#endif
+    for (; i < count; ++i)
+        if (values[i] == best) return i;
+    return -1; // only NaNs
+}
+
+// -- LINK-CUT TREES --
+// A forest whose trees are split into preferred paths, each held in a splay
+// tree ordered by depth, so every operation is amortized O(log n). Nodes
+// carry a value and each splay subtree knows its heaviest node, which makes
+// the heaviest node on any tree path one access away. Weighted edges are
+// modelled as nodes of their own sitting between their endpoints.
+class LinkCutForest {
+    struct Node {
+        int child[2] = { -1, -1 };
+        int parent = -1;     // splay parent, or path parent at a splay root
+        bool flipped = false; // children still to be swapped, for rerooting
+        float value = 0;
+        int heaviest = -1;   // heaviest node in this splay subtree
+    };
+    vector<Node> nodes;
+    vector<int> freeNodes;
+    vector<int> pending; // splay's path to the root, scratch
+
+    bool isSplayRoot(int x) const {
+        int p = nodes[x].parent;
+        return p == -1 || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+    }
+
+    void pull(int x) {
+        int best = x;
+        for (int c : nodes[x].child)
+            if (c != -1 && nodes[nodes[c].heaviest].value > nodes[best].value)
+                best = nodes[c].heaviest;
+        nodes[x].heaviest = best;
+    }
+
+    void push(int x) {
+        if (!nodes[x].flipped) return;
+        swap(nodes[x].child[0], nodes[x].child[1]);
+        for (int c : nodes[x].child)
+            if (c != -1) nodes[c].flipped = !nodes[c].flipped;
+        nodes[x].flipped = false;
+    }
+
+    void rotate(int x) {
+        int p = nodes[x].parent, g = nodes[p].parent;
+        int side = nodes[p].child[1] == x;
+        int moved = nodes[x].child[!side];
+        if (!isSplayRoot(p))
+            nodes[g].child[nodes[g].child[1] == p] = x;
+        nodes[x].parent = g;
+        nodes[x].child[!side] = p;
+        nodes[p].parent = x;
+        nodes[p].child[side] = moved;
+        if (moved != -1) nodes[moved].parent = p;
+        pull(p);
+        pull(x);
+    }
+
+    void splay(int x) {
+        pending.clear();
+        for (int y = x;; y = nodes[y].parent) {
+            pending.push_back(y);
+            if (isSplayRoot(y)) break;
         }
-        else if (unicode >= 32 && unicode < 128) {
-            userInput += static_cast<char>(unicode);
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it)
+            push(*it);
+        while (!isSplayRoot(x)) {
+            int p = nodes[x].parent, g = nodes[p].parent;
+            if (!isSplayRoot(p))
+                rotate((nodes[g].child[1] == p) == (nodes[p].child[1] == x) ? p : x);
+            rotate(x);
         }
-        inputText.setString(userInput);
     }
 
-    void processEdgeInput() {
-        istringstream iss(userInput);
-        int from, to;
-        float cap;
-        if (iss >> from >> to >> cap) {
-            addEdge(from, to, cap);
+    // Makes the path from x's tree root to x preferred, with x at its splay root
+    void access(int x) {
+        for (int below = -1, y = x; y != -1; below = y, y = nodes[y].parent) {
+            splay(y);
+            nodes[y].child[1] = below;
+            pull(y);
         }
-        userInput.clear();
-        inputText.setString("");
+        splay(x);
     }
 
-    void startMaxFlow() {
-        totalFlow = 0;
-        vector<int> parent(nodes.size());
-        animating = true;
+    void makeRoot(int x) {
+        access(x);
+        nodes[x].flipped = !nodes[x].flipped;
+    }
 
-        while (bfs(0, nodes.size() - 1, parent)) {
-            float pathFlow = 1e9f;
-            for (int v = nodes.size() - 1; v != 0; v = parent[v]) {
-                int u = parent[v];
-                pathFlow = min(pathFlow, getResidualCapacity(u, v));
-            }
+    int findRoot(int x) {
+        access(x);
+        for (push(x); nodes[x].child[0] != -1; push(x))
+            x = nodes[x].child[0];
+        splay(x);
+        return x;
+    }
 
-            for (int v = nodes.size() - 1; v != 0; v = parent[v]) {
-                int u = parent[v];
-                updateFlow(u, v, pathFlow);
-            }
+public:
+    int add(float value) {
+        int x = nodes.size();
+        if (freeNodes.empty()) {
+            nodes.emplace_back();
+        }
+        else {
+            x = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[x] = Node();
+        }
+        nodes[x].value = value;
+        nodes[x].heaviest = x;
+        return x;
+    }
 
-            totalFlow += pathFlow;
+    // x must have been cut from everything
+    void remove(int x) {
+        freeNodes.push_back(x);
+    }
 
-            currentPath.clear();
-            for (int v = nodes.size() - 1; v != -1; v = parent[v])
-                currentPath.push_back(v);
-            reverse(currentPath.begin(), currentPath.end());
+    void clear() {
+        nodes.clear();
+        freeNodes.clear();
+    }
 
-            walker.setPosition(nodes[currentPath[0]].position);
-            animationIndex = 0;
+    float value(int x) const {
+        return nodes[x].value;
+    }
 
-            animateWalkerAlongPath();
+    bool connected(int a, int b) {
+        return a == b || findRoot(a) == findRoot(b);
+    }
 
-            stringstream ss;
-            ss << "Max Flow so far: " << totalFlow;
-            maxFlowText.setString(ss.str());
+    // a and b must be in different trees
+    void link(int a, int b) {
+        makeRoot(a);
+        nodes[a].parent = b;
+    }
 
-            this_thread::sleep_for(chrono::milliseconds(500));
-        }
+    // a and b must be adjacent
+    void cut(int a, int b) {
+        makeRoot(a);
+        access(b);
+        nodes[b].child[0] = -1;
+        nodes[a].parent = -1;
+        pull(b);
+    }
 
-        stringstream ss;
-        ss << "Final Max Flow: " << totalFlow;
-        maxFlowText.setString(ss.str());
+    // a and b must be connected
+    int heaviestOnPath(int a, int b) {
+        makeRoot(a);
+        access(b);
+        return nodes[b].heaviest;
+    }
+};
 
-        animating = false;
+// -- FORCE LAYOUT --
+// Spreads a graph out by simulation: every pair of nodes repels, every edge
+// pulls its ends together like a spring, and a weak pull towards the middle
+// keeps loose components on screen. Repulsion is approximated with a
+// Barnes-Hut quadtree, so an iteration costs O(n log n), and is split across
+// the worker pool. step() runs as many iterations as fit in the frame budget
+// while the temperature, the furthest a node may move in one iteration, cools
+// until the layout settles. Pinned nodes stay put but still push and pull.
+class ForceLayout {
+    struct Quad {
+        Vector2f center;  // of mass
+        float mass = 0;
+        Vector2f corner;  // top left
+        float size = 0;
+        int child = -1;   // first of four consecutive children; -1 for a leaf
+        int body = -1;    // the node in a leaf
+    };
+
+    static constexpr float theta = 0.8f;    // cells smaller than this times their distance count as one body
+    static constexpr float cooling = 0.97f;
+    static constexpr float settled = 0.25f; // px per iteration
+    static const int maxDepth = 24;         // coincident nodes share a leaf below this
+
+    vector<Vector2f> positions;
+    vector<Vector2f> moves;
+    vector<pair<int, int>> springs;
+    vector<char> pinned; // kept across runs
+    vector<Quad> tree;
+    FloatRect area;
+    float idealLength = 60;
+    float gravity = 0;
+    float temperature = 0;
+
+public:
+    bool isRunning() const {
+        return temperature > settled;
     }
 
-    void animateWalkerAlongPath() {
-        if (currentPath.size() < 2) return;
+    // Lays out from the given positions; springs are node index pairs
+    void start(vector<Vector2f> nodePositions, vector<pair<int, int>> edgeEnds, FloatRect bounds) {
+        positions = move(nodePositions);
+        springs = move(edgeEnds);
+        area = bounds;
+        pinned.resize(positions.size());
+        moves.assign(positions.size(), Vector2f());
+        float n = static_cast<float>(max<size_t>(1, positions.size()));
+        idealLength = max(5.f, min(120.f, 0.75f * sqrt(area.width * area.height / n)));
+        // n nodes repelling each other inside a linear pull settle into a disc
+        // of radius sqrt(k^2 n / gravity); size it to fill the area
+        float radius = 0.45f * min(area.width, area.height);
+        gravity = idealLength * idealLength * n / (radius * radius);
+        temperature = positions.size() > 1 ? max(area.width, area.height) / 10 : 0;
+    }
 
-        for (size_t i = 0; i < currentPath.size() - 1; ++i) {
-            Vector2f start = nodes[currentPath[i]].position;
-            Vector2f end = nodes[currentPath[i + 1]].position;
+    void stop() {
+        temperature = 0;
+    }
 
-            Vector2f dir = end - start;
-            float length = sqrt(dir.x * dir.x + dir.y * dir.y);
-            dir /= length;
+    // Forgets the pins too, for a view that was cleared
+    void clear() {
+        stop();
+        pinned.clear();
+    }
 
-            float moved = 0.f;
-            walker.setPosition(start);
+    bool isPinned(size_t node) const {
+        return node < pinned.size() && pinned[node];
+    }
 
-            while (moved < length && renderWindow != nullptr) {
-                float step = 2.f;
-                walker.move(dir * step);
-                moved += step;
+    void togglePin(size_t node) {
+        if (node >= pinned.size()) pinned.resize(node + 1);
+        pinned[node] = !pinned[node];
+    }
 
-                renderWindow->clear();
-                draw(*renderWindow);
-                renderWindow->display();
+    const vector<Vector2f>& getPositions() const {
+        return positions;
+    }
 
-                sleep(milliseconds(10));
-            }
+    // Runs iterations for this frame's budget, at least one; false once settled
+    bool step() {
+        if (!isRunning()) return false;
+        TraceZone zone("Force layout");
+        FrameBudget budget;
+        do {
+            iterate();
+        } while (isRunning() && !budget.spent());
+        return isRunning();
+    }
 
-            walker.setPosition(end);
-            if (renderWindow != nullptr) {
-                renderWindow->clear();
-                draw(*renderWindow);
-                renderWindow->display();
-            }
+private:
+    void iterate() {
+        buildTree();
+        parallelFor(positions.size(), 256, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                moves[i] = repulsion(i);
+        });
+
+        for (const auto& spring : springs) {
+            Vector2f delta = positions[spring.second] - positions[spring.first];
+            float length = sqrt(delta.x * delta.x + delta.y * delta.y);
+            Vector2f pull = delta * (length / idealLength);
+            moves[spring.first] += pull;
+            moves[spring.second] -= pull;
+        }
 
-            sleep(milliseconds(200));  // Pause at node
+        Vector2f middle(area.left + area.width / 2, area.top + area.height / 2);
+        for (size_t i = 0; i < positions.size(); ++i) {
+            if (pinned[i]) continue;
+            Vector2f shift = moves[i] + (middle - positions[i]) * gravity;
+            float length = sqrt(shift.x * shift.x + shift.y * shift.y);
+            if (length > 0)
+                positions[i] += shift * (min(length, temperature) / length);
+            positions[i].x = max(area.left, min(area.left + area.width, positions[i].x));
+            positions[i].y = max(area.top, min(area.top + area.height, positions[i].y));
         }
+        temperature *= cooling;
     }
 
-    bool bfs(int src, int sink, vector<int>& parent) {
-        vector<bool> visited(nodes.size(), false);
-        queue<int> q;
-        q.push(src);
-        visited[src] = true;
-        parent[src] = -1;
-
-        while (!q.empty()) {
-            int u = q.front();
-            q.pop();
+    void buildTree() {
+        tree.clear();
+        Vector2f low = positions[0], high = positions[0];
+        for (const Vector2f& p : positions) {
+            low.x = min(low.x, p.x);
+            low.y = min(low.y, p.y);
+            high.x = max(high.x, p.x);
+            high.y = max(high.y, p.y);
+        }
+        Quad root;
+        root.corner = low;
+        root.size = max(high.x - low.x, high.y - low.y) + 1;
+        tree.push_back(root);
+        for (size_t i = 0; i < positions.size(); ++i)
+            insert(i);
+    }
 
-            for (auto& edge : edges) {
-                if (edge.from == u && !visited[edge.to] && getResidualCapacity(u, edge.to) > 0) {
-                    parent[edge.to] = u;
-                    visited[edge.to] = true;
-                    q.push(edge.to);
-                    if (edge.to == sink) return true;
+    void insert(int body) {
+        Vector2f p = positions[body];
+        int q = 0;
+        for (int depth = 0;; ++depth) {
+            tree[q].mass += 1;
+            tree[q].center += (p - tree[q].center) / tree[q].mass;
+            if (tree[q].child == -1) {
+                if (tree[q].mass == 1) {
+                    tree[q].body = body;
+                    return;
                 }
+                if (depth == maxDepth) return;
+                // Split the leaf and move the body it held one level down
+                int held = tree[q].body;
+                subdivide(q);
+                int c = childFor(q, positions[held]);
+                tree[c].mass = 1;
+                tree[c].center = positions[held];
+                tree[c].body = held;
+                tree[q].body = -1;
             }
+            q = childFor(q, p);
         }
-        return false;
     }
 
-    float getResidualCapacity(int from, int to) {
-        for (auto& edge : edges) {
-            if (edge.from == from && edge.to == to)
-                return edge.capacity - edge.flow;
+    void subdivide(int q) {
+        float half = tree[q].size / 2;
+        Vector2f corner = tree[q].corner;
+        tree[q].child = tree.size();
+        for (int k = 0; k < 4; ++k) {
+            Quad child;
+            child.corner = corner + Vector2f((k & 1) * half, (k >> 1) * half);
+            child.size = half;
+            tree.push_back(child);
         }
-        return 0;
     }
 
-    void updateFlow(int from, int to, float flow) {
-        for (auto& edge : edges) {
-            if (edge.from == from && edge.to == to) edge.flow += flow;
-            if (edge.from == to && edge.to == from) edge.flow -= flow;
+    int childFor(int q, Vector2f p) const {
+        const Quad& quad = tree[q];
+        float half = quad.size / 2;
+        int k = (p.x >= quad.corner.x + half ? 1 : 0) | (p.y >= quad.corner.y + half ? 2 : 0);
+        return quad.child + k;
+    }
+
+    // Fruchterman-Reingold repulsion, k^2 / d, from every other node
+    Vector2f repulsion(int i) const {
+        Vector2f p = positions[i], force;
+        int stack[3 * maxDepth + 4];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Quad& quad = tree[stack[--top]];
+            if (quad.mass == 0 || (quad.body == i && quad.mass == 1)) continue;
+            Vector2f d = p - quad.center;
+            float distance2 = d.x * d.x + d.y * d.y;
+            if (quad.child != -1 && quad.size * quad.size > theta * theta * distance2) {
+                for (int k = 0; k < 4; ++k)
+                    stack[top++] = quad.child + k;
+                continue;
+            }
+            if (distance2 < 0.01f) {
+                // On top of each other: push apart in a direction fixed per node
+                d = Vector2f(cos(i * 2.4f), sin(i * 2.4f)) * 0.1f;
+                distance2 = 0.01f;
+            }
+            force += d * (idealLength * idealLength * quad.mass / distance2);
         }
+        return force;
     }
+};
 
-    bool isRestartButtonClicked(Vector2f pos) {
-        return restartButton.getGlobalBounds().contains(pos);
+// Screen space the node views lay graphs out in, clear of their controls
+FloatRect layoutArea() {
+    VideoMode desktop = VideoMode::getDesktopMode();
+    float width = max(200.f, desktop.width - 420.f);
+    float height = max(200.f, desktop.height - 200.f);
+    return FloatRect(40, 140, width, height);
+}
+
+// Index of the node under pos, or -1
+template <typename Node>
+int nodeAt(const vector<Node>& nodes, Vector2f pos, float radius) {
+    for (size_t i = nodes.size(); i-- > 0;) {
+        Vector2f offset = pos - nodes[i].position;
+        if (offset.x * offset.x + offset.y * offset.y <= radius * radius)
+            return i;
     }
+    return -1;
+}
 
-    void draw(RenderWindow& window) {
-        window.draw(instructionText);
-        window.draw(button);
-        window.draw(buttonText);
-        window.draw(maxFlowText);
-        window.draw(inputPrompt);
-        window.draw(inputText);
-        window.draw(exitButton);
-        window.draw(exitButtonText);
-        //new code added here
-        window.draw(restartButton);
-        window.draw(restartButtonText);
+class InputBox {
+public:
+    RectangleShape box;
+    Text inputText;
+    Font font;
+    string content;
+    bool dirty = true;
 
+    InputBox() {
+        font.loadFromFile("arial.ttf");
+        box.setSize(Vector2f(300, 30));
+        box.setFillColor(Color(200, 200, 200));
+        box.setPosition(20, 20);
 
-        for (auto& edge : edges) {
-            if (edge.capacity == 0) continue;
-            Vertex line[] = {
-                Vertex(nodes[edge.from].position, Color::White),
-                Vertex(nodes[edge.to].position, Color::White)
-            };
-            window.draw(line, 2, Lines);
+        inputText.setFont(font);
+        inputText.setCharacterSize(18);
+        inputText.setFillColor(Color::Black);
+        inputText.setPosition(25, 25);
+    }
 
-            // Draw flow/capacity
-            Text flowText;
-            flowText.setFont(font);
-            flowText.setCharacterSize(14);
-            flowText.setFillColor(Color::Yellow);
-            Vector2f mid = (nodes[edge.from].position + nodes[edge.to].position) / 2.f;
-            flowText.setPosition(mid);
-            flowText.setString(to_string(static_cast<int>(edge.flow)) + "/" +
-                to_string(static_cast<int>(edge.capacity)));
-            window.draw(flowText);
-        }
+    void draw(Canvas& window) {
+        window.draw(box);
+        inputText.setString(content);
+        window.draw(inputText);
+    }
 
-        for (auto& node : nodes) {
-            window.draw(node.shape);
-            window.draw(node.label);
-        }
+    void addChar(char c) {
+        if (c == '\b' && !content.empty())
+            content.pop_back();
+        else if (c != '\b')
+            content += c;
+        dirty = true;
+    }
 
-        if (animating)
-            window.draw(walker);
+    void clear() {
+        content.clear();
+        dirty = true;
+    }
+
+    bool consumeDirty() {
+        bool wasDirty = dirty;
+        dirty = false;
+        return wasDirty;
     }
 };
 
+// -- SHORTEST PATHS --
+// The searches behind the Dijkstra view as step generators over an edge list
+// whose edges come in twin pairs. The view animates one at a time; the
+// comparison view runs several at once, each on its own instance.
+using DistQueue = priority_queue<pair<float, int>, pmr::vector<pair<float, int>>, greater<pair<float, int>>>;
 
-//prims algorithm
+class ShortestPaths {
+    const vector<Edge>& edges;
+    const vector<vector<int>>& adjacency; // edge indices leaving each node
+    ScratchArena scratch; // queues of the running search
+    static constexpr int landmarkCount = 8;
+    vector<vector<float>> landmarkDist; // per landmark, distance to every node
 
-class PrimsVisualizer {
-private:
-    struct Node {
-        Vector2f position;
-        CircleShape shape;
-        Text label;
-        float originalRadius = 10.f;
-        float pulseRadius = 10.f;
-        bool isPulsing = false;
-        Clock pulseClock;
-    };
+public:
+    // Labels of the last search. A bidirectional search labels the target
+    // side in backDist and backParent, the next node towards the target.
+    // Point-to-point searches leave their path in path.
+    vector<float> dist;
+    vector<int> parent;
+    vector<float> backDist;
+    vector<int> backParent;
+    vector<int> path;
+
+    ShortestPaths(const vector<Edge>& edges, const vector<vector<int>>& adjacency) : edges(edges), adjacency(adjacency) {}
+
+    bool hasLandmarks() const {
+        return !landmarkDist.empty();
+    }
 
-    struct Edge {
-        int from;
-        int to;
-        float weight;
-        bool isHighlighted = false;
-        Color color = Color::White;
-    };
+    // Call whenever the graph changes
+    void clearLandmarks() {
+        landmarkDist.clear();
+    }
 
-    struct AnimationStep {
-        int currentNode;
-        int addedNode;
-        int fromNode;
-        float weight;
-        bool isNodeSelection; // true for node selection, false for edge addition
-    };
+    // The tables only depend on the graph, so searches on other instances
+    // over the same graph can share them
+    const vector<vector<float>>& landmarkTables() const {
+        return landmarkDist;
+    }
 
-    vector<Node> nodes;
-    vector<Edge> edges;
-    vector<Text> edgeLabels;
-    vector<Vertex> mstLines;
+    void useLandmarks(vector<vector<float>> tables) {
+        landmarkDist = move(tables);
+    }
 
-    Font font;
-    Text buttonText, mstWeightText, instructionText, inputPrompt, inputText, statusText;
-    RectangleShape button;
-    RectangleShape exitButton;
-    Text exitButtonText;
-    RectangleShape restartButton;
-    Text restartButtonText;
-    string userInput;
-    float totalMSTWeight = 0.0f;
-    bool showMST = false;
+    // Full shortest path tree from start
+    Generator<int> dijkstra(int start) {
+        ScopedRun run("Dijkstra");
+        dist.assign(adjacency.size(), numeric_limits<float>::max());
+        parent.assign(adjacency.size(), -1);
+        dist[start] = 0;
+        DistQueue pq(greater<pair<float, int>>{}, pmr::vector<pair<float, int>>(scratch.reset()));
+        pq.push({ 0, start });
+        ++perf.heapPushes;
+        Generator<int> settled = settleSteps(edges, adjacency, dist, parent, move(pq));
+        while (settled.next()) {
+            run.pause();
+            co_yield settled.value();
+            run.resume();
+        }
+    }
 
-    // Animation-related members
-    vector<AnimationStep> animationSteps;
-    size_t currentAnimationStep = 0;
-    Clock animationClock;
-    bool isAnimating = false;
-    float animationSpeed = 2.0f; // seconds per step
-    vector<int> nodesInMST;
-    vector<Vertex> animatedMSTLines;
-    int currentHighlightedEdge = -1;
-    int currentConsideredNode = -1;
+    // Dijkstra from both ends, always advancing the side whose queue has the
+    // smaller top. best is the shortest source-target path seen so far through
+    // a node labelled from both sides; once the two tops add up to at least
+    // best, no path through an unsettled node can be shorter. Nodes settled
+    // from the target are yielded as -1 - u.
+    Generator<int> bidirectional(int source, int target) {
+        ScopedRun run("Bidirectional Dijkstra");
+        const float inf = numeric_limits<float>::max();
+        int n = adjacency.size();
+        dist.assign(n, inf);
+        parent.assign(n, -1);
+        backDist.assign(n, inf);
+        backParent.assign(n, -1);
+        path.clear();
+        pmr::memory_resource* memory = scratch.reset();
+        DistQueue forward(greater<pair<float, int>>{}, pmr::vector<pair<float, int>>(memory));
+        DistQueue backward(greater<pair<float, int>>{}, pmr::vector<pair<float, int>>(memory));
+        dist[source] = 0;
+        backDist[target] = 0;
+        forward.push({ 0, source });
+        backward.push({ 0, target });
+        perf.heapPushes += 2;
+        float best = source == target ? 0 : inf;
+        int meet = source == target ? source : -1;
+
+        while (!forward.empty() && !backward.empty() && forward.top().first + backward.top().first < best) {
+            bool forwardSide = forward.top().first <= backward.top().first;
+            DistQueue& queue = forwardSide ? forward : backward;
+            vector<float>& near = forwardSide ? dist : backDist;
+            vector<float>& far = forwardSide ? backDist : dist;
+            vector<int>& via = forwardSide ? parent : backParent;
+            int u = queue.top().second;
+            float d = queue.top().first;
+            queue.pop();
+            if (d > near[u]) continue;
+            ++perf.expansions;
+            for (int i : adjacency[u]) {
+                int v = edges[i].to;
+                float w = edges[i].weight;
+                ++perf.relaxations;
+                if (near[u] + w < near[v]) {
+                    near[v] = near[u] + w;
+                    via[v] = u;
+                    queue.push({ near[v], v });
+                    ++perf.heapPushes;
+                }
+                if (far[v] != inf && near[v] + far[v] < best) {
+                    best = near[v] + far[v];
+                    meet = v;
+                }
+            }
+            run.pause();
+            co_yield forwardSide ? u : -1 - u;
+            run.resume();
+        }
 
-public:
-    PrimsVisualizer() {
-        font.loadFromFile("arial.ttf");
+        if (meet == -1) co_return;
+        for (int v = meet; v != -1; v = parent[v])
+            path.push_back(v);
+        reverse(path.begin(), path.end());
+        for (int v = backParent[meet]; v != -1; v = backParent[v])
+            path.push_back(v);
+    }
 
-        button.setSize(Vector2f(200, 35));
-        button.setFillColor(Color(0, 100, 0));
-        button.setPosition(830, 20);
+    // A* whose heuristic is the landmark bound: for any landmark L,
+    // |d(L, target) - d(L, v)| <= d(v, target) by the triangle inequality.
+    // The bound is consistent, so every node is settled at most once. The
+    // landmark tables are built from the node positions if there are none.
+    Generator<int> landmarks(int source, int target, vector<Vector2f> positions) {
+        ScopedRun run("ALT");
+        const float inf = numeric_limits<float>::max();
+        if (landmarkDist.empty())
+            buildLandmarks(positions);
+        auto bound = [&](int v) {
+            float h = 0;
+            for (const vector<float>& fromLandmark : landmarkDist) {
+                float dt = fromLandmark[target], dv = fromLandmark[v];
+                if ((dt == inf) != (dv == inf)) return inf; // different components
+                if (dt != inf) h = max(h, abs(dt - dv));
+            }
+            return h;
+        };
 
-        buttonText.setFont(font);
-        buttonText.setString("Run Prim's Algorithm");
-        buttonText.setCharacterSize(17);
-        buttonText.setFillColor(Color::White);
-        buttonText.setPosition(840, 28);
+        int n = adjacency.size();
+        dist.assign(n, inf);
+        parent.assign(n, -1);
+        path.clear();
+        pmr::memory_resource* memory = scratch.reset();
+        pmr::vector<bool> settled(n, false, memory);
+        DistQueue open(greater<pair<float, int>>{}, pmr::vector<pair<float, int>>(memory));
+        dist[source] = 0;
+        float h = bound(source);
+        if (h == inf) co_return;
+        open.push({ h, source });
+        ++perf.heapPushes;
+
+        while (!open.empty()) {
+            int u = open.top().second;
+            open.pop();
+            if (settled[u]) continue;
+            settled[u] = true;
+            ++perf.expansions;
+            if (u == target) break;
+            for (int i : adjacency[u]) {
+                int v = edges[i].to;
+                float w = edges[i].weight;
+                ++perf.relaxations;
+                if (dist[u] + w < dist[v]) {
+                    dist[v] = dist[u] + w;
+                    parent[v] = u;
+                    open.push({ dist[v] + bound(v), v });
+                    ++perf.heapPushes;
+                }
+            }
+            run.pause();
+            co_yield u;
+            run.resume();
+        }
 
-        instructionText.setFont(font);
-        instructionText.setCharacterSize(20);
-        instructionText.setFillColor(Color::Yellow);
-        instructionText.setPosition(20, 10);
-        instructionText.setString("Click to add nodes. Type edges like: 0 1 10 and press Enter.");
+        if (dist[target] == inf) co_return;
+        for (int v = target; v != -1; v = parent[v])
+            path.push_back(v);
+        reverse(path.begin(), path.end());
+    }
 
-        inputPrompt.setFont(font);
-        inputPrompt.setCharacterSize(20);
-        inputPrompt.setFillColor(Color::Yellow);
-        inputPrompt.setPosition(20, 520);
-        inputPrompt.setString("Edge Input (format: from to weight):");
+    // Landmarks are spread out by farthest-point selection over the node
+    // positions, then their distance tables are filled in parallel
+    void buildLandmarks(const vector<Vector2f>& positions) {
+        TraceZone zone("Landmark precompute");
+        int n = positions.size();
+        vector<int> picked;
+        vector<float> nearest(n, numeric_limits<float>::max());
+        Vector2f middle;
+        for (Vector2f position : positions)
+            middle += position / static_cast<float>(n);
+        Vector2f from = middle;
+        while ((int)picked.size() < min(landmarkCount, n)) {
+            int farthest = 0;
+            for (int v = 0; v < n; v++) {
+                Vector2f d = positions[v] - from;
+                nearest[v] = min(nearest[v], d.x * d.x + d.y * d.y);
+                if (nearest[v] > nearest[farthest]) farthest = v;
+            }
+            if (!picked.empty() && nearest[farthest] == 0) break; // only duplicates left
+            picked.push_back(farthest);
+            from = positions[farthest];
+        }
 
-        inputText.setFont(font);
-        inputText.setCharacterSize(20);
+        landmarkDist.assign(picked.size(), vector<float>());
+        parallelFor(picked.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t l = begin; l < end; ++l)
+                landmarkDist[l] = distancesFrom(picked[l]);
+        });
+    }
+
+    // Plain Dijkstra for the landmark tables; runs on worker threads, so it
+    // keeps to its own memory
+    vector<float> distancesFrom(int source) const {
+        vector<float> distance(adjacency.size(), numeric_limits<float>::max());
+        priority_queue<pair<float, int>, vector<pair<float, int>>, greater<pair<float, int>>> pq;
+        distance[source] = 0;
+        pq.push({ 0, source });
+        while (!pq.empty()) {
+            int u = pq.top().second;
+            float d = pq.top().first;
+            pq.pop();
+            if (d > distance[u]) continue;
+            for (int i : adjacency[u]) {
+                int v = edges[i].to;
+                if (d + edges[i].weight < distance[v]) {
+                    distance[v] = d + edges[i].weight;
+                    pq.push({ distance[v], v });
+                }
+            }
+        }
+        return distance;
+    }
+
+    // Dijkstra main loop over whatever the queue was seeded with, yielding
+    // each node as it is settled. The graph must not change while it runs.
+    static Generator<int> settleSteps(const vector<Edge>& edges, const vector<vector<int>>& adjacency,
+        vector<float>& dist, vector<int>& parent, DistQueue pq) {
+        while (!pq.empty()) {
+            int u = pq.top().second;
+            float d = pq.top().first;
+            pq.pop();
+            if (d > dist[u]) continue;
+            ++perf.expansions;
+            for (int i : adjacency[u]) {
+                int v = edges[i].to;
+                float w = edges[i].weight;
+                ++perf.relaxations;
+                if (dist[u] + w < dist[v]) {
+                    dist[v] = dist[u] + w;
+                    parent[v] = u;
+                    pq.push({ dist[v], v });
+                    ++perf.heapPushes;
+                }
+            }
+            co_yield u;
+        }
+    }
+
+};
+
+// -- RUN HISTORY --
+// A run is recorded as a flat array of int slots (whatever a view needs to
+// redraw one moment of it) plus the slots each step changed, delta encoded as
+// varint (slot gap, zigzag value delta) pairs. A full copy of the slots is kept
+// every `interval` steps, so a seek restores the nearest copy at or before the
+// step and replays at most one interval of changes. When the copies outgrow
+// their budget every other one is dropped and the interval doubles; the change
+// stream has a cap of its own, past which recording stops.
+class RunHistory {
+    struct Keyframe {
+        size_t step;
+        size_t offset; // into events
+        vector<int32_t> state;
+    };
+    vector<int32_t> live;                 // slots after the last recorded step
+    vector<pair<int, int32_t>> pending;   // slot and value before each change of this step
+    vector<Uint8> events;
+    vector<Keyframe> keyframes;           // sorted by step, the first at step 0
+    size_t steps = 0;
+    size_t interval = 64;
+    bool truncated = false;
+
+    // Seeks resume from the last one when they can, so playing forwards
+    // decodes each step once
+    vector<int32_t> cursor;
+    size_t cursorStep = 0;
+    size_t cursorOffset = 0;
+    bool cursorValid = false;
+
+public:
+    static constexpr size_t keyframeBudget = size_t(32) << 20;
+    static constexpr size_t eventBudget = size_t(256) << 20;
+
+    void begin(vector<int32_t> initial) {
+        clear();
+        live = move(initial);
+        // Restoring a keyframe copies every slot anyway, so replaying up to a
+        // sixteenth as many steps after it costs about the same
+        interval = max<size_t>(64, bit_ceil(live.size() / 16));
+        keyframes.push_back({ 0, 0, live });
+    }
+
+    void clear() {
+        live.clear();
+        pending.clear();
+        events.clear();
+        keyframes.clear();
+        cursor.clear();
+        steps = 0;
+        interval = 64;
+        truncated = false;
+        cursorValid = false;
+    }
+
+    bool empty() const {
+        return keyframes.empty();
+    }
+
+    size_t stepCount() const {
+        return steps;
+    }
+
+    bool isTruncated() const {
+        return truncated;
+    }
+
+    // Slot value as of the step being recorded
+    int32_t current(int slot) const {
+        return live[slot];
+    }
+
+    void set(int slot, int32_t value) {
+        if (keyframes.empty() || live[slot] == value) return;
+        pending.push_back({ slot, live[slot] });
+        live[slot] = value;
+    }
+
+    // Closes the step being recorded; a step that changed nothing still counts
+    void endStep() {
+        if (keyframes.empty() || truncated) {
+            pending.clear();
+            return;
+        }
+        // The first entry of a slot has its value before the step
+        stable_sort(pending.begin(), pending.end(),
+            [](const pair<int, int32_t>& a, const pair<int, int32_t>& b) { return a.first < b.first; });
+        size_t count = 0;
+        for (size_t i = 0; i < pending.size(); ++i) {
+            if (i > 0 && pending[i].first == pending[i - 1].first) continue;
+            if (live[pending[i].first] != pending[i].second) pending[count++] = pending[i];
+        }
+        pending.resize(count);
+
+        putVarint(count);
+        int previous = 0;
+        for (auto [slot, old] : pending) {
+            uint32_t delta = uint32_t(live[slot]) - uint32_t(old);
+            putVarint(slot - previous);
+            putVarint((delta << 1) ^ uint32_t(int32_t(delta) >> 31));
+            previous = slot;
+        }
+        pending.clear();
+        ++steps;
+
+        if (events.size() > eventBudget)
+            truncated = true; // the step just written is kept, later ones are not
+        else if (steps % interval == 0)
+            addKeyframe();
+    }
+
+    // Slots after the given number of steps
+    const vector<int32_t>& seek(size_t step) {
+        step = min(step, steps);
+        auto next = upper_bound(keyframes.begin(), keyframes.end(), step,
+            [](size_t s, const Keyframe& k) { return s < k.step; });
+        const Keyframe& base = *prev(next);
+        if (!cursorValid || cursorStep > step || cursorStep < base.step) {
+            cursor = base.state;
+            cursorStep = base.step;
+            cursorOffset = base.offset;
+            cursorValid = true;
+        }
+        while (cursorStep < step) {
+            size_t count = getVarint(cursorOffset);
+            int slot = 0;
+            for (size_t i = 0; i < count; ++i) {
+                slot += getVarint(cursorOffset);
+                uint32_t zigzag = getVarint(cursorOffset);
+                uint32_t delta = (zigzag >> 1) ^ (0u - (zigzag & 1));
+                cursor[slot] = int32_t(uint32_t(cursor[slot]) + delta);
+            }
+            ++cursorStep;
+        }
+        return cursor;
+    }
+
+    size_t memoryBytes() const {
+        size_t bytes = events.capacity() + (live.capacity() + cursor.capacity()) * sizeof(int32_t) +
+            pending.capacity() * sizeof(pending[0]);
+        for (const Keyframe& keyframe : keyframes)
+            bytes += keyframe.state.capacity() * sizeof(int32_t);
+        return bytes;
+    }
+
+private:
+    void addKeyframe() {
+        keyframes.push_back({ steps, events.size(), live });
+        size_t keyframeBytes = sizeof(Keyframe) + live.size() * sizeof(int32_t);
+        if (keyframes.size() > 2 && keyframes.size() * keyframeBytes > keyframeBudget) {
+            interval *= 2;
+            erase_if(keyframes, [&](const Keyframe& k) { return k.step % interval != 0; });
+        }
+    }
+
+    void putVarint(uint32_t value) {
+        while (value >= 0x80) {
+            events.push_back(Uint8(value | 0x80));
+            value >>= 7;
+        }
+        events.push_back(Uint8(value));
+    }
+
+    uint32_t getVarint(size_t& offset) const {
+        uint32_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            Uint8 byte = events[offset++];
+            value |= uint32_t(byte & 0x7f) << shift;
+            if (byte < 0x80) return value;
+        }
+    }
+};
+
+// Strip along the bottom of the screen the timelines sit in
+FloatRect scrubArea() {
+    VideoMode desktop = VideoMode::getDesktopMode();
+    return FloatRect(40, desktop.height - 40.f, max(200.f, desktop.width - 80.f), 10);
+}
+
+// Timeline under a view's recorded run. Click or drag it, or use Left/Right
+// (Shift for bigger jumps), Home and End. Away from the live end the view
+// draws shown() instead of its own state; the run itself carries on.
+class ScrubBar {
+    Font font;
+    RectangleShape track;
+    RectangleShape progress;
+    RectangleShape handle;
+    Text label;
+    size_t step = 0;
+    bool scrubbing = false;
+    bool dragging = false;
+    bool changed = false;
+
+public:
+    RunHistory history; // the view records into it
+
+    ScrubBar() {
+        font.loadFromFile("arial.ttf");
+        FloatRect area = scrubArea();
+        track.setPosition(area.left, area.top);
+        track.setSize({ area.width, area.height });
+        track.setFillColor(Color(80, 80, 80));
+
+        progress.setPosition(area.left, area.top);
+        progress.setFillColor(Color(0, 170, 255));
+
+        handle.setSize({ 6, area.height + 8 });
+        handle.setOrigin(3, 4);
+        handle.setFillColor(Color::White);
+
+        label.setFont(font);
+        label.setCharacterSize(14);
+        label.setFillColor(Color::White);
+        label.setPosition(area.left, area.top - 22);
+    }
+
+    void begin(vector<int32_t> initial) {
+        history.begin(move(initial));
+        toLive();
+    }
+
+    void clear() {
+        history.clear();
+        toLive();
+    }
+
+    bool isScrubbing() const {
+        return scrubbing;
+    }
+
+    const vector<int32_t>& shown() {
+        return history.seek(step);
+    }
+
+    void toLive() {
+        changed |= scrubbing;
+        scrubbing = false;
+        dragging = false;
+    }
+
+    // Anything past the last recorded step follows the live run again
+    void seek(size_t target) {
+        changed = true;
+        scrubbing = target < history.stepCount();
+        step = target;
+    }
+
+    // True if the event was meant for the timeline
+    bool handleEvent(const Event& event, Vector2f pos) {
+        if (history.stepCount() == 0) return false;
+        size_t steps = history.stepCount();
+        size_t at = scrubbing ? step : steps;
+        if (event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Left) {
+            FloatRect hit = track.getGlobalBounds();
+            hit.top -= 8;
+            hit.height += 16;
+            if (!hit.contains(pos)) return false;
+            dragging = true;
+        }
+        else if (event.type == Event::MouseButtonReleased && dragging) {
+            dragging = false;
+            return true;
+        }
+        else if (event.type == Event::KeyPressed) {
+            size_t jump = event.key.shift ? max<size_t>(1, steps / 20) : 1;
+            if (event.key.code == Keyboard::Left) seek(at > jump ? at - jump : 0);
+            else if (event.key.code == Keyboard::Right) seek(at + jump);
+            else if (event.key.code == Keyboard::Home) seek(0);
+            else if (event.key.code == Keyboard::End) toLive();
+            else return false;
+            return true;
+        }
+        if (event.type != Event::MouseMoved && event.type != Event::MouseButtonPressed) return false;
+        if (!dragging) return false;
+        float fraction = (pos.x - track.getPosition().x) / track.getSize().x;
+        seek(size_t(llround(max(0.f, min(1.f, fraction)) * steps)));
+        return true;
+    }
+
+    bool consumeChanged() {
+        bool wasChanged = changed;
+        changed = false;
+        return wasChanged;
+    }
+
+    void draw(Canvas& window) {
+        size_t steps = history.stepCount();
+        if (steps == 0) return;
+        size_t at = scrubbing ? step : steps;
+        float x = track.getSize().x * at / steps;
+        progress.setSize({ x, track.getSize().y });
+        handle.setPosition(track.getPosition().x + x, track.getPosition().y);
+
+        stringstream ss;
+        if (scrubbing) ss << "Step " << at << " / " << steps;
+        else ss << "Live, " << steps << " steps";
+        ss << fixed << setprecision(1) << "   " << history.memoryBytes() / 1048576.0 << " MB";
+        if (history.isTruncated()) ss << " (memory cap reached, later steps not recorded)";
+        ss << "   Left/Right, Shift for bigger jumps, Home/End";
+        label.setString(ss.str());
+
+        window.draw(track);
+        window.draw(progress);
+        window.draw(handle);
+        window.draw(label);
+    }
+};
+
+class Graph {
+    RectangleShape exitButton;
+    Text exitButtonText;
+    RectangleShape restartButton;
+    Text restartButtonText;
+private:
+    // Drawn through nodeBatch; a node's label is its index
+    struct Node {
+        Vector2f position;
+    };
+
+    vector<Node> nodes;
+    vector<Edge> edges;
+    vector<vector<int>> adjacency; // edge indices leaving each node
+    vector<Text> edgeLabels;
+    vector<Vertex> pathLines;
+    vector<int> shortestPath;
+    size_t animationIndex = 0;
+    bool animatePath = false;
+
+    // Shortest path tree kept from the last search so edge edits can repair it
+    vector<float> dist;
+    vector<int> parent;
+    int treeSource = -1;
+    bool dirty = true; // something visible changed since the last frame
+    StaticLayer staticLayer; // edges, edge labels and nodes
+    ScratchArena scratch; // repair queues
+
+    // A full search is pumped a few milliseconds per frame by update(); edits
+    // bump graphVersion so a search started on an older graph is restarted
+    // before it is resumed again
+    ShortestPaths paths{ edges, adjacency };
+    Generator<int> search;
+    unsigned graphVersion = 0;
+    unsigned searchVersion = 0;
+    int searchSource = 0;
+    int searchTarget = -1;
+    // A bidirectional search can settle a node from both sides, so progress
+    // counts distinct nodes and the stats line counts each side
+    vector<uint8_t> settledSides; // per node: bit 1 from the source, bit 2 from the target
+    size_t settledCount = 0;
+    size_t forwardSettled = 0, backwardSettled = 0;
+    int shownProgress = -1;
+
+    // Point-to-point modes answer one query without building a full tree,
+    // so edits re-run the query instead of repairing
+    enum SearchMode { FullTree, Bidirectional, Landmarks };
+    SearchMode mode = FullTree;
+    bool pointQuery = false; // the shown path came from a point-to-point query
+    // Recorded search: per node 0 unsettled, 1 settled from the source, 2 from
+    // the target, then per node its parent + 1 when it was settled
+    ScrubBar scrubBar;
+
+   CircleShape walker;
+   Font font;
+   NodeBatch nodeBatch{ font, 15 }; // scratch, refilled for each draw
+   ForceLayout layout;
+   Text instruction;
+   RectangleShape button;
+   Text buttonText;
+   RectangleShape modeButton;
+   Text modeText;
+   Text statsText;
+
+public:
+    Graph() {
+        font.loadFromFile("arial.ttf");
+
+        instruction.setFont(font);
+        instruction.setCharacterSize(16);
+        instruction.setFillColor(Color::White);
+        instruction.setPosition(20, 60);
+        instruction.setString("Click to add nodes. Type edges as: from to weight");
+
+        button.setSize({ 200, 40 });
+        button.setPosition(20, 520);
+        button.setFillColor(Color::White);
+
+        buttonText.setFont(font);
+        buttonText.setCharacterSize(18);
+        buttonText.setFillColor(Color::Black);
+        buttonText.setString("Find Shortest Path");
+        buttonText.setPosition(30, 528);
+
+        modeButton.setSize({ 200, 40 });
+        modeButton.setPosition(240, 520);
+        modeButton.setFillColor(Color(200, 200, 200));
+
+        modeText.setFont(font);
+        modeText.setCharacterSize(18);
+        modeText.setFillColor(Color::Black);
+        modeText.setPosition(250, 528);
+
+        statsText.setFont(font);
+        statsText.setCharacterSize(16);
+        statsText.setFillColor(Color::White);
+        statsText.setPosition(20, 570);
+        setMode(FullTree);
+
+        exitButton.setSize({ 150, 35 });
+        exitButton.setFillColor(Color(150, 0, 0));
+        exitButton.setPosition(650, 20);
+
+        exitButtonText.setFont(font);
+        exitButtonText.setCharacterSize(18);
+        exitButtonText.setFillColor(Color::White);
+        exitButtonText.setString("Exit");
+        exitButtonText.setPosition(680, 25);
+
+
+        walker.setRadius(8.f);
+        walker.setFillColor(Color::Yellow);
+        walker.setOrigin(8.f, 8.f);
+        //new code added
+        restartButton.setSize({ 150, 35 });
+        restartButton.setFillColor(Color::Blue);
+        restartButton.setPosition(470, 20);
+
+        restartButtonText.setFont(font);
+        restartButtonText.setCharacterSize(18);
+        restartButtonText.setFillColor(Color::White);
+        restartButtonText.setString("Restart");
+        restartButtonText.setPosition(500, 25);
+    }
+    void reset() {
+        nodes.clear();
+        edges.clear();
+        adjacency.clear();
+        edgeLabels.clear();
+        pathLines.clear();
+        shortestPath.clear();
+        animationIndex = 0;
+        animatePath = false;
+        dist.clear();
+        parent.clear();
+        treeSource = -1;
+        pointQuery = false;
+        paths.clearLandmarks();
+        statsText.setString("");
+        scrubBar.clear();
+        dirty = true;
+        staticLayer.invalidate();
+        layout.clear();
+        cancelRun();
+    }
+    void cancelRun() {
+        search.reset();
+        layout.stop();
+        buttonText.setString("Find Shortest Path");
+    }
+    bool isRestartButtonClicked(Vector2f pos) {
+        return restartButton.getGlobalBounds().contains(pos);
+    }
+    void draw(Canvas& window) {
+        staticLayer.draw(window, [&](Canvas& layer) {
+            for (size_t i = 0; i < edges.size(); i++) {
+                Vertex line[] = {
+                    Vertex(nodes[edges[i].from].position, Color::White),
+                    Vertex(nodes[edges[i].to].position,Color::White)
+                };
+                layer.draw(line, 2, Lines);
+                layer.draw(edgeLabels[i]);
+            }
+            nodeBatch.clear();
+            for (size_t i = 0; i < nodes.size(); i++)
+                addToBatch(i);
+            nodeBatch.draw(layer);
+        });
+
+        if (scrubBar.isScrubbing())
+            drawRecordedSearch(window);
+        else {
+            if (!pathLines.empty())
+                window.draw(&pathLines[0], pathLines.size(), Lines);
+
+            // Nodes on the path go back on top of the highlighted lines
+            if (!shortestPath.empty()) {
+                nodeBatch.clear();
+                for (int v : shortestPath)
+                    addToBatch(v);
+                nodeBatch.draw(window);
+            }
+
+            if (animatePath)
+                window.draw(walker);
+        }
+
+        window.draw(instruction);
+        window.draw(button);
+        window.draw(buttonText);
+        window.draw(modeButton);
+        window.draw(modeText);
+        window.draw(statsText);
+        window.draw(exitButton);
+        window.draw(exitButtonText);
+        window.draw(restartButton);
+        window.draw(restartButtonText);
+        scrubBar.draw(window);
+    }
+
+    void addNode(Vector2f pos) {
+        layout.stop(); // it only knows the nodes it started with
+        nodes.push_back({ pos });
+        adjacency.emplace_back();
+        staticLayer.invalidate();
+        ++graphVersion;
+        paths.clearLandmarks();
+        scrubBar.clear(); // recorded on another graph
+
+        // The target is always the last node, so a new node moves it
+        if (treeSource != -1) {
+            dist.push_back(numeric_limits<float>::max());
+            parent.push_back(-1);
+            rebuildPath(nodes.size() - 1);
+        }
+        else if (pointQuery) {
+            findShortestPath(searchSource, nodes.size() - 1);
+        }
+    }
+
+    void addEdgeFromText(const string& str) {
+        istringstream iss(str);
+        int u, v;
+        float w;
+        if (!(iss >> u >> v >> w)) return;
+        int n = nodes.size();
+        if (u < 0 || v < 0 || u >= n || v >= n || u == v) return;
+
+        // Re-entering an existing edge changes its weight instead of duplicating it
+        for (int i : adjacency[u]) {
+            if (edges[i].to != v) continue;
+            float old = edges[i].weight;
+            if (w == old) return;
+            edgesChanged();
+            edges[i].weight = w;
+            edges[i ^ 1].weight = w;
+            edgeLabels[i].setString(to_string(static_cast<int>(w)));
+            edgeLabels[i ^ 1].setString(to_string(static_cast<int>(w)));
+            if (pointQuery) findShortestPath(searchSource, n - 1);
+            if (treeSource == -1) return;
+            if (w < old)
+                repairTree(u, v);
+            else
+                findShortestPath(treeSource, n - 1); // increases can invalidate the tree
+            return;
+        }
+
+        edgesChanged();
+        layout.stop(); // it only knows the springs it started with
+        adjacency[u].push_back(edges.size());
+        edges.push_back({ u, v, w });
+        adjacency[v].push_back(edges.size());
+        edges.push_back({ v, u, w });
+
+        Text label;
+        label.setFont(font);
+        label.setCharacterSize(15);
+        label.setFillColor(Color::Red);
+        Vector2f mid = (nodes[u].position + nodes[v].position) / 2.f;
+        label.setPosition(mid);
+        label.setString(to_string(static_cast<int>(w)));
+        edgeLabels.push_back(label);
+        edgeLabels.push_back(label);
+
+        if (treeSource != -1)
+            repairTree(u, v);
+        else if (pointQuery)
+            findShortestPath(searchSource, n - 1);
+    }
+
+    void handleClick(Vector2f pos) {
+        dirty = true;
+        if (button.getGlobalBounds().contains(pos)) {
+            findShortestPath(0, nodes.size() - 1);
+            animatePath = true;
+            animationIndex = 0;
+            if (!shortestPath.empty())
+                walker.setPosition(nodes[shortestPath[0]].position);
+        }
+        else if (modeButton.getGlobalBounds().contains(pos)) {
+            setMode(static_cast<SearchMode>((mode + 1) % 3));
+        }
+        else {
+            addNode(pos);
+        }
+    }
+
+    void update() {
+        if (layout.isRunning()) {
+            layout.step();
+            moveNodes(layout.getPositions());
+        }
+
+        if (search.isRunning() && searchVersion != graphVersion)
+            findShortestPath(searchSource, nodes.size() - 1); // graph edited mid-search
+
+        if (search.isRunning() && !pumpSteps(search, [&](int u) { countSettled(u); recordSettled(u); })) {
+            search.reset();
+            buttonText.setString("Find Shortest Path");
+            if (mode == FullTree) {
+                dist.swap(paths.dist); // both buffers are kept for the next search
+                parent.swap(paths.parent);
+                treeSource = searchSource;
+                rebuildPath(searchTarget);
+            }
+            else {
+                pointQuery = true;
+                showPath(paths.path);
+            }
+            string sides = mode == Bidirectional ?
+                ": " + to_string(forwardSettled) + " forward, " + to_string(backwardSettled) + " backward" : "";
+            statsText.setString("Settled " + to_string(settledCount) + " of " + to_string(nodes.size()) +
+                " nodes" + sides + " (" + modeName() + ")");
+            dirty = true;
+        }
+        else if (search.isRunning()) {
+            int percent = static_cast<int>(100.f * settledCount / nodes.size());
+            if (percent != shownProgress) {
+                shownProgress = percent;
+                buttonText.setString("Searching... " + to_string(percent) + "%");
+                dirty = true;
+            }
+        }
+
+        if (animatePath && animationIndex + 1 < shortestPath.size()) {
+            Vector2f current = walker.getPosition();
+            Vector2f target = nodes[shortestPath[animationIndex + 1]].position;
+            Vector2f dir = target - current;
+            float dist = sqrt(dir.x * dir.x + dir.y * dir.y);
+            if (dist > 1.5f) {
+                dir /= dist;
+                walker.move(dir * 2.f);
+            }
+            else {
+                walker.setPosition(target);
+                animationIndex++;
+            }
+            dirty = true;
+        }
+    }
+
+    bool isAnimating() const {
+        return animatePath && animationIndex + 1 < shortestPath.size();
+    }
+
+    // Needs update() every frame: animating, laying out or waiting on a search
+    bool isBusy() const {
+        return isAnimating() || search.isRunning() || layout.isRunning();
+    }
+
+    // F6: spreads the graph out from where the nodes are now, or stops
+    void toggleLayout() {
+        dirty = true;
+        if (layout.isRunning()) {
+            layout.stop();
+            return;
+        }
+        if (search.isRunning()) return;
+        vector<Vector2f> positions;
+        for (const Node& node : nodes)
+            positions.push_back(node.position);
+        vector<pair<int, int>> springs;
+        for (size_t i = 0; i < edges.size(); i += 2)
+            springs.push_back({ edges[i].from, edges[i].to });
+        layout.start(move(positions), move(springs), layoutArea());
+    }
+
+    // Right click: a pinned node keeps its place while the layout runs
+    void togglePin(Vector2f pos) {
+        int v = nodeAt(nodes, pos, 10);
+        if (v == -1) return;
+        layout.togglePin(v);
+        staticLayer.invalidate();
+        dirty = true;
+    }
+
+    bool consumeDirty() {
+        bool wasDirty = dirty | scrubBar.consumeChanged();
+        dirty = false;
+        return wasDirty;
+    }
+
+    ScrubBar& scrubber() {
+        return scrubBar;
+    }
+
+    // Starts a search that update() advances each frame and adopts once it
+    // finishes. Until then edits have no tree to repair.
+    void findShortestPath(int start, int end) {
+        int n = nodes.size();
+        if (start < 0 || start >= n) return;
+        treeSource = -1;
+        pointQuery = false;
+        searchSource = start;
+        searchTarget = end;
+        searchVersion = graphVersion;
+        settledSides.assign(n, 0);
+        settledCount = forwardSettled = backwardSettled = 0;
+        shownProgress = -1;
+        search.reset(); // must let go of the arena before the next one resets it
+        scrubBar.begin(vector<int32_t>(2 * n, 0));
+        if (mode == Bidirectional)
+            search = paths.bidirectional(start, end);
+        else if (mode == Landmarks)
+            search = paths.landmarks(start, end, nodePositions());
+        else
+            search = paths.dijkstra(start);
+    }
+
+    // The mode button cycles through these; a running search is dropped
+    void setMode(SearchMode next) {
+        mode = next;
+        modeText.setString(string("Mode: ") + modeName());
+        if (search.isRunning()) {
+            search.reset();
+            buttonText.setString("Find Shortest Path");
+        }
+        dirty = true;
+    }
+
+    const char* modeName() const {
+        return mode == Bidirectional ? "Bidirectional" : mode == Landmarks ? "ALT" : "Dijkstra";
+    }
+
+    bool isExitButtonClicked(Vector2f pos) {
+        return exitButton.getGlobalBounds().contains(pos);
+    }
+
+private:
+    // Only for real edits: a running search restarts, and the recorded run
+    // and landmark tables belong to the old weights
+    void edgesChanged() {
+        dirty = true;
+        staticLayer.invalidate();
+        ++graphVersion;
+        paths.clearLandmarks();
+        scrubBar.clear();
+    }
+
+    void addToBatch(int v, Color fill = Color::Blue) {
+        Vector2f pos = nodes[v].position;
+        nodeBatch.addDisc(pos, 10, fill, layout.isPinned(v) ? Color::Red : Color::Transparent);
+        nodeBatch.addLabel(to_string(v), Vector2f(pos.x - 5, pos.y - 20), Color::White);
+    }
+
+    vector<Vector2f> nodePositions() const {
+        vector<Vector2f> positions;
+        for (const Node& node : nodes)
+            positions.push_back(node.position);
+        return positions;
+    }
+
+    void countSettled(int u) {
+        bool fromTarget = u < 0;
+        if (fromTarget) u = -1 - u;
+        uint8_t side = fromTarget ? 2 : 1;
+        if (settledSides[u] & side) return;
+        if (settledSides[u] == 0) ++settledCount;
+        settledSides[u] |= side;
+        ++(fromTarget ? backwardSettled : forwardSettled);
+    }
+
+    // Search generators yield -1 - u for a node settled from the target
+    void recordSettled(int u) {
+        bool fromTarget = u < 0;
+        if (fromTarget) u = -1 - u;
+        RunHistory& history = scrubBar.history;
+        history.set(u, fromTarget ? 2 : 1);
+        history.set(nodes.size() + u, (fromTarget ? paths.backParent : paths.parent)[u] + 1);
+        history.endStep();
+    }
+
+    // The search as it stood at the scrubbed step: settled nodes and the edges
+    // they were settled through, orange from the source and purple from the target
+    void drawRecordedSearch(Canvas& window) {
+        const vector<int32_t>& state = scrubBar.shown();
+        int n = nodes.size();
+        vector<Vertex> lines;
+        nodeBatch.clear();
+        for (int v = 0; v < n; ++v) {
+            if (state[v] == 0) continue;
+            Color color = state[v] == 1 ? Color(255, 140, 0) : Color(180, 80, 255);
+            int from = state[n + v] - 1;
+            if (from >= 0) {
+                lines.push_back(Vertex(nodes[from].position, color));
+                lines.push_back(Vertex(nodes[v].position, color));
+            }
+            addToBatch(v, color);
+        }
+        if (!lines.empty())
+            window.draw(&lines[0], lines.size(), Lines);
+        nodeBatch.draw(window);
+    }
+
+    // An inserted or cheaper edge u-v can only shorten paths through it, so
+    // only its endpoints need to be re-seeded; everything else stays settled.
+    void repairTree(int u, int v) {
+        int seed = -1;
+        for (int i : adjacency[u]) {
+            if (edges[i].to != v) continue;
+            float w = edges[i].weight;
+            if (dist[u] != numeric_limits<float>::max() && dist[u] + w < dist[v]) {
+                dist[v] = dist[u] + w;
+                parent[v] = u;
+                seed = v;
+            }
+            else if (dist[v] != numeric_limits<float>::max() && dist[v] + w < dist[u]) {
+                dist[u] = dist[v] + w;
+                parent[u] = v;
+                seed = u;
+            }
+        }
+        if (seed == -1) return;
+        ScopedRun run("Dijkstra repair");
+        DistQueue pq(greater<pair<float, int>>{}, pmr::vector<pair<float, int>>(scratch.reset()));
+        pq.push({ dist[seed], seed });
+        ++perf.heapPushes;
+        Generator<int> settled = ShortestPaths::settleSteps(edges, adjacency, dist, parent, move(pq));
+        while (settled.next()) {}
+        rebuildPath(nodes.size() - 1);
+    }
+
+    void rebuildPath(int end) {
+        vector<int> path;
+        if (end >= 0 && end < (int)dist.size() && dist[end] != numeric_limits<float>::max()) {
+            for (int v = end; v != -1; v = parent[v])
+                path.push_back(v);
+            reverse(path.begin(), path.end());
+        }
+        showPath(path);
+    }
+
+    void showPath(const vector<int>& path) {
+        vector<int> previous = shortestPath;
+        shortestPath = path;
+
+        // Restart the walker if the route it was following changed
+        if (animatePath && shortestPath != previous) {
+            animationIndex = 0;
+            if (!shortestPath.empty())
+                walker.setPosition(nodes[shortestPath[0]].position);
+        }
+
+        rebuildPathLines();
+    }
+
+    void rebuildPathLines() {
+        pathLines.clear();
+        for (size_t i = 1; i < shortestPath.size(); ++i) {
+            pathLines.push_back(Vertex(nodes[shortestPath[i - 1]].position, Color::Cyan));
+            pathLines.push_back(Vertex(nodes[shortestPath[i]].position, Color::Cyan));
+        }
+    }
+
+    // Takes positions from the layout and moves everything drawn from them
+    void moveNodes(const vector<Vector2f>& positions) {
+        for (size_t i = 0; i < nodes.size(); i++)
+            nodes[i].position = positions[i];
+        for (size_t i = 0; i < edges.size(); i++)
+            edgeLabels[i].setPosition((positions[edges[i].from] + positions[edges[i].to]) / 2.f);
+        rebuildPathLines();
+        staticLayer.invalidate();
+        dirty = true;
+    }
+};
+
+//A* algorithm 
+struct Cell {
+    int row, col;
+    bool isWall = false;
+    bool isVisited = false;
+    bool isPath = false;
+    int cost = 1; // terrain cost of stepping into the cell
+    float g = INFINITY, h = 0;
+    Cell* parent = nullptr;
+};
+
+// Lifelong Planning A*: keeps g/rhs values between searches so a wall edit
+// only re-expands the cells whose distance from the start actually changed.
+class LPAStarPlanner {
+    const vector<vector<Cell>>* grid = nullptr;
+    int rows = 0, cols = 0;
+    int startIdx = -1, goalIdx = -1;
+    vector<float> g, rhs;
+
+    using Key = pair<float, float>;
+    struct Entry {
+        Key key;
+        int idx;
+        bool operator>(const Entry& other) const { return key > other.key; }
+    };
+    priority_queue<Entry, vector<Entry>, greater<Entry>> open;
+
+public:
+    vector<int> touched; // cells expanded by the last computeShortestPath()
+
+    void reset(const vector<vector<Cell>>& cells, const Cell* start, const Cell* goal) {
+        grid = &cells;
+        rows = cells.size();
+        cols = rows ? cells[0].size() : 0;
+        startIdx = start->row * cols + start->col;
+        goalIdx = goal->row * cols + goal->col;
+        g.assign(rows * cols, INFINITY);
+        rhs.assign(rows * cols, INFINITY);
+        open = {};
+        rhs[startIdx] = 0;
+        open.push({ calculateKey(startIdx), startIdx });
+    }
+
+    bool isReady() const {
+        return grid != nullptr;
+    }
+
+    // Moves a planner primed on a copy of the grid over to the original; both
+    // must have the same walls
+    void rebind(const vector<vector<Cell>>& cells) {
+        grid = &cells;
+    }
+
+    // Call after a cell's wall state or terrain cost changes; its edges to all
+    // neighbours changed
+    void cellChanged(int row, int col) {
+        int idx = row * cols + col;
+        updateVertex(idx);
+        forEachNeighbor(idx, [&](int n) { updateVertex(n); });
+    }
+
+    // False if there is no path, or if the token was cancelled, which leaves
+    // the planner half updated and only good for discarding
+    bool computeShortestPath(const CancelToken& token = CancelToken()) {
+        touched.clear();
+        while (true) {
+            popStale();
+            if (open.empty()) break;
+            if (!(open.top().key < calculateKey(goalIdx)) && rhs[goalIdx] == g[goalIdx]) break;
+
+            int u = open.top().idx;
+            open.pop();
+            touched.push_back(u);
+            if (touched.size() % 256 == 0) {
+                if (token.isCancelled()) return false;
+                token.report(static_cast<float>(touched.size()) / (rows * cols));
+            }
+            if (g[u] > rhs[u]) {
+                g[u] = rhs[u];
+                forEachNeighbor(u, [&](int n) { updateVertex(n); });
+            }
+            else {
+                g[u] = INFINITY;
+                updateVertex(u);
+                forEachNeighbor(u, [&](int n) { updateVertex(n); });
+            }
+        }
+        return g[goalIdx] != INFINITY;
+    }
+
+    // Start-to-goal cell indices, following decreasing g from the goal
+    vector<int> path() const {
+        vector<int> result;
+        if (g[goalIdx] == INFINITY) return result;
+        int current = goalIdx;
+        result.push_back(current);
+        while (current != startIdx) {
+            int best = -1;
+            forEachNeighbor(current, [&](int n) {
+                if (!isWall(n) && (best == -1 || g[n] < g[best])) best = n;
+            });
+            if (best == -1 || g[best] >= g[current]) return {};
+            current = best;
+            result.push_back(current);
+        }
+        reverse(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    bool isWall(int idx) const {
+        return (*grid)[idx / cols][idx % cols].isWall;
+    }
+
+    int cost(int idx) const {
+        return (*grid)[idx / cols][idx % cols].cost;
+    }
+
+    float heuristic(int idx) const {
+        return abs(idx / cols - goalIdx / cols) + abs(idx % cols - goalIdx % cols);
+    }
+
+    Key calculateKey(int idx) const {
+        float m = min(g[idx], rhs[idx]);
+        return { m + heuristic(idx), m };
+    }
+
+    template <typename F>
+    void forEachNeighbor(int idx, F&& f) const {
+        int r = idx / cols, c = idx % cols;
+        if (r > 0) f(idx - cols);
+        if (r + 1 < rows) f(idx + cols);
+        if (c > 0) f(idx - 1);
+        if (c + 1 < cols) f(idx + 1);
+    }
+
+    void updateVertex(int idx) {
+        if (idx != startIdx) {
+            float best = INFINITY;
+            if (!isWall(idx))
+                forEachNeighbor(idx, [&](int n) {
+                    if (!isWall(n)) best = min(best, g[n] + cost(idx));
+                });
+            rhs[idx] = best;
+        }
+        // Stale heap entries are skipped lazily instead of being removed here
+        if (g[idx] != rhs[idx])
+            open.push({ calculateKey(idx), idx });
+    }
+
+    void popStale() {
+        while (!open.empty()) {
+            const Entry& top = open.top();
+            if (g[top.idx] != rhs[top.idx] && top.key == calculateKey(top.idx)) return;
+            open.pop();
+        }
+    }
+};
+
+// HPA*: the grid is cut into square clusters joined by entrance cells on their
+// borders. Entrance-to-entrance distances inside each cluster are cached, so a
+// query searches the small abstract graph first and only then refines each hop
+// with a search confined to one cluster. Wall edits rebuild just the clusters
+// whose interior or borders contain the edited cell.
+class HierarchicalPlanner {
+    struct Cluster {
+        int top = 0, left = 0, height = 0, width = 0;
+        vector<int> entrances;         // cell indices
+        vector<vector<int>> partners;  // per entrance: entrance cells across a border
+        vector<float> dist;            // entrances.size()^2 intra-cluster distances
+    };
+
+    const vector<vector<Cell>>* grid = nullptr;
+    int rows = 0, cols = 0;
+    int clusterSize;
+    int clusterRows = 0, clusterCols = 0;
+    vector<Cluster> clusters;
+    vector<int> entranceSlot; // cell index -> position in its cluster's entrance list, or -1
+
+public:
+    vector<int> clusterWork;  // cells touched per cluster by the last build/query
+    int abstractExpanded = 0;
+    int refinedCells = 0;
+
+    explicit HierarchicalPlanner(int clusterSize = 10) : clusterSize(clusterSize) {}
+
+    bool isBuilt() const {
+        return grid != nullptr;
+    }
+
+    void invalidate() {
+        grid = nullptr;
+        clusters.clear();
+    }
+
+    int entranceCount() const {
+        int total = 0;
+        for (const auto& c : clusters) total += c.entrances.size();
+        return total;
+    }
+
+    const vector<int>& entrancesOf(int cluster) const {
+        return clusters[cluster].entrances;
+    }
+
+    int clusterCount() const {
+        return clusters.size();
+    }
+
+    // Cluster extent in cells: left/top column and row, width/height in cells
+    IntRect clusterBounds(int cluster) const {
+        const Cluster& c = clusters[cluster];
+        return IntRect(c.left, c.top, c.width, c.height);
+    }
+
+    void build(const vector<vector<Cell>>& cells) {
+        grid = &cells;
+        rows = cells.size();
+        cols = rows ? cells[0].size() : 0;
+        clusterRows = (rows + clusterSize - 1) / clusterSize;
+        clusterCols = (cols + clusterSize - 1) / clusterSize;
+        clusters.assign(clusterRows * clusterCols, Cluster());
+        entranceSlot.assign(rows * cols, -1);
+        clusterWork.assign(clusters.size(), 0);
+        for (int cr = 0; cr < clusterRows; ++cr) {
+            for (int cc = 0; cc < clusterCols; ++cc) {
+                Cluster& c = clusters[cr * clusterCols + cc];
+                c.top = cr * clusterSize;
+                c.left = cc * clusterSize;
+                c.height = min(clusterSize, rows - c.top);
+                c.width = min(clusterSize, cols - c.left);
+            }
+        }
+        for (int i = 0; i < (int)clusters.size(); ++i)
+            rebuildCluster(i);
+    }
+
+    // Call after the wall at (row, col) flipped
+    void cellChanged(int row, int col) {
+        int cr = row / clusterSize, cc = col / clusterSize;
+        const Cluster& home = clusters[cr * clusterCols + cc];
+        fill(clusterWork.begin(), clusterWork.end(), 0);
+
+        // Border cells also change the entrances of the cluster across that border
+        vector<int> dirty = { cr * clusterCols + cc };
+        if (row == home.top && cr > 0) dirty.push_back((cr - 1) * clusterCols + cc);
+        if (row == home.top + home.height - 1 && cr + 1 < clusterRows) dirty.push_back((cr + 1) * clusterCols + cc);
+        if (col == home.left && cc > 0) dirty.push_back(cr * clusterCols + cc - 1);
+        if (col == home.left + home.width - 1 && cc + 1 < clusterCols) dirty.push_back(cr * clusterCols + cc + 1);
+        for (int i : dirty)
+            rebuildCluster(i);
+    }
+
+    // Returns start-to-goal cell indices, or an empty path if none was found
+    vector<int> findPath(const Cell* start, const Cell* goal) {
+        fill(clusterWork.begin(), clusterWork.end(), 0);
+        abstractExpanded = 0;
+        refinedCells = 0;
+
+        int s = start->row * cols + start->col;
+        int t = goal->row * cols + goal->col;
+        int sc = clusterOf(s), tc = clusterOf(t);
+
+        // Connect start and goal to the entrances of their own clusters
+        vector<int> fromStart, fromGoal;
+        bfsInCluster(s, sc, fromStart, nullptr);
+        bfsInCluster(t, tc, fromGoal, nullptr);
+
+        struct Open {
+            float f;
+            int cell;
+            bool operator>(const Open& other) const { return f > other.f; }
+        };
+        unordered_map<int, float> gScore;
+        unordered_map<int, int> cameFrom;
+        priority_queue<Open, vector<Open>, greater<Open>> open;
+        auto relax = [&](int from, int to, float cost) {
+            auto it = gScore.find(to);
+            if (it == gScore.end() || cost < it->second) {
+                gScore[to] = cost;
+                cameFrom[to] = from;
+                open.push({ cost + heuristic(to, t), to });
+            }
+        };
+
+        gScore[s] = 0;
+        open.push({ heuristic(s, t), s });
+        while (!open.empty()) {
+            Open top = open.top();
+            open.pop();
+            int u = top.cell;
+            float gu = gScore[u];
+            if (top.f > gu + heuristic(u, t)) continue;
+            if (u == t) break;
+            ++abstractExpanded;
+
+            if (u == s) {
+                if (sc == tc && localDist(fromStart, t, sc) >= 0)
+                    relax(u, t, localDist(fromStart, t, sc));
+                for (int e : clusters[sc].entrances)
+                    if (localDist(fromStart, e, sc) >= 0)
+                        relax(u, e, localDist(fromStart, e, sc));
+                if (entranceSlot[s] == -1) continue;
+            }
+
+            int uc = clusterOf(u);
+            const Cluster& c = clusters[uc];
+            int slot = entranceSlot[u];
+            int k = c.entrances.size();
+            for (int j = 0; j < k; ++j) {
+                float d = c.dist[slot * k + j];
+                if (j != slot && d != INFINITY)
+                    relax(u, c.entrances[j], gu + d);
+            }
+            for (int p : c.partners[slot])
+                relax(u, p, gu + 1);
+            if (uc == tc && localDist(fromGoal, u, tc) >= 0)
+                relax(u, t, gu + localDist(fromGoal, u, tc));
+        }
+
+        if (!gScore.count(t)) return {};
+
+        vector<int> waypoints;
+        for (int v = t; v != s; v = cameFrom[v])
+            waypoints.push_back(v);
+        waypoints.push_back(s);
+        reverse(waypoints.begin(), waypoints.end());
+
+        // Refine each abstract hop into grid cells
+        vector<int> path = { s };
+        for (size_t i = 1; i < waypoints.size(); ++i) {
+            int a = waypoints[i - 1], b = waypoints[i];
+            if (clusterOf(a) != clusterOf(b)) {
+                path.push_back(b);
+                continue;
+            }
+            int cl = clusterOf(a);
+            vector<int> dist, parent;
+            bfsInCluster(a, cl, dist, &parent);
+            refinedCells += clusters[cl].width * clusters[cl].height;
+            vector<int> hop;
+            for (int v = toLocal(b, cl); v != toLocal(a, cl); v = parent[v])
+                hop.push_back(toGlobal(v, cl));
+            path.insert(path.end(), hop.rbegin(), hop.rend());
+        }
+        return path;
+    }
+
+private:
+    int clusterOf(int idx) const {
+        return (idx / cols) / clusterSize * clusterCols + (idx % cols) / clusterSize;
+    }
+
+    int toLocal(int idx, int cluster) const {
+        const Cluster& c = clusters[cluster];
+        return (idx / cols - c.top) * c.width + (idx % cols - c.left);
+    }
+
+    int toGlobal(int local, int cluster) const {
+        const Cluster& c = clusters[cluster];
+        return (c.top + local / c.width) * cols + c.left + local % c.width;
+    }
+
+    int localDist(const vector<int>& dist, int idx, int cluster) const {
+        return dist[toLocal(idx, cluster)];
+    }
+
+    bool isWall(int idx) const {
+        return (*grid)[idx / cols][idx % cols].isWall;
+    }
+
+    float heuristic(int a, int b) const {
+        return abs(a / cols - b / cols) + abs(a % cols - b % cols);
+    }
+
+    // Unit-cost BFS that never leaves the cluster; distances are -1 when unreachable
+    void bfsInCluster(int source, int cluster, vector<int>& dist, vector<int>* parent) {
+        const Cluster& c = clusters[cluster];
+        dist.assign(c.width * c.height, -1);
+        if (parent) parent->assign(c.width * c.height, -1);
+        if (isWall(source)) return;
+
+        queue<int> q;
+        dist[toLocal(source, cluster)] = 0;
+        q.push(toLocal(source, cluster));
+        while (!q.empty()) {
+            int u = q.front();
+            q.pop();
+            ++clusterWork[cluster];
+            int r = u / c.width, col = u % c.width;
+            int dr[] = { -1, 1, 0, 0 };
+            int dc[] = { 0, 0, -1, 1 };
+            for (int i = 0; i < 4; ++i) {
+                int nr = r + dr[i], nc = col + dc[i];
+                if (nr < 0 || nr >= c.height || nc < 0 || nc >= c.width) continue;
+                int v = nr * c.width + nc;
+                if (dist[v] != -1 || isWall(toGlobal(v, cluster))) continue;
+                dist[v] = dist[u] + 1;
+                if (parent) (*parent)[v] = u;
+                q.push(v);
+            }
+        }
+    }
+
+    // Appends the transitions along one side of a cluster. Each maximal run of
+    // open cell pairs gets one transition in its middle, or two at its ends
+    // when it is long, as in the original HPA* paper.
+    void collectSide(Cluster& c, int inside0, int outside0, int step, int length) {
+        int run = 0;
+        for (int i = 0; i <= length; ++i) {
+            bool open = i < length && !isWall(inside0 + i * step) && !isWall(outside0 + i * step);
+            if (open) {
+                ++run;
+                continue;
+            }
+            if (run > 0) {
+                int first = i - run, last = i - 1;
+                if (run < 6) {
+                    int mid = (first + last) / 2;
+                    addTransition(c, inside0 + mid * step, outside0 + mid * step);
+                }
+                else {
+                    addTransition(c, inside0 + first * step, outside0 + first * step);
+                    addTransition(c, inside0 + last * step, outside0 + last * step);
+                }
+            }
+            run = 0;
+        }
+    }
+
+    void addTransition(Cluster& c, int inside, int outside) {
+        int slot = entranceSlot[inside];
+        if (slot == -1) {
+            slot = c.entrances.size();
+            entranceSlot[inside] = slot;
+            c.entrances.push_back(inside);
+            c.partners.emplace_back();
+        }
+        c.partners[slot].push_back(outside);
+    }
+
+    void rebuildCluster(int index) {
+        Cluster& c = clusters[index];
+        for (int e : c.entrances) entranceSlot[e] = -1;
+        c.entrances.clear();
+        c.partners.clear();
+
+        // Sides are scanned the same way from both clusters, so transitions pair up
+        int topLeft = c.top * cols + c.left;
+        int bottomLeft = (c.top + c.height - 1) * cols + c.left;
+        int topRight = c.top * cols + c.left + c.width - 1;
+        if (c.top > 0) collectSide(c, topLeft, topLeft - cols, 1, c.width);
+        if (c.top + c.height < rows) collectSide(c, bottomLeft, bottomLeft + cols, 1, c.width);
+        if (c.left > 0) collectSide(c, topLeft, topLeft - 1, cols, c.height);
+        if (c.left + c.width < cols) collectSide(c, topRight, topRight + 1, cols, c.height);
+
+        int k = c.entrances.size();
+        c.dist.assign(k * k, INFINITY);
+        vector<int> dist;
+        for (int i = 0; i < k; ++i) {
+            bfsInCluster(c.entrances[i], index, dist, nullptr);
+            for (int j = 0; j < k; ++j) {
+                int d = dist[toLocal(c.entrances[j], index)];
+                if (d >= 0) c.dist[i * k + j] = d;
+            }
+        }
+    }
+};
+
+// Read-only snapshot of the walls, safe to share between threads
+struct WallMap {
+    int rows = 0, cols = 0;
+    vector<uint8_t> blocked;
+
+    WallMap() = default;
+
+    explicit WallMap(const vector<vector<Cell>>& grid) {
+        rows = grid.size();
+        cols = rows ? grid[0].size() : 0;
+        blocked.resize(rows * cols);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                blocked[r * cols + c] = grid[r][c].isWall;
+    }
+};
+
+// Per-thread A* scratch. Cells are stamped with a query generation, so a new
+// query never has to clear arrays sized to the whole grid.
+class GridSearchState {
+    vector<int> g;
+    vector<int> parent;
+    vector<uint32_t> stamp;
+    uint32_t generation = 0;
+    vector<pair<int, int>> heap; // (f, cell) min-heap
+
+public:
+    long long expansions = 0;
+
+    // Writes the start-to-goal path into `path`; returns false if unreachable.
+    // goalDistance, when given, holds exact steps to this goal for every cell
+    // and replaces the Manhattan heuristic. expanded, when given, collects the
+    // cells in the order they were expanded.
+    bool findPath(const WallMap& map, int start, int goal, vector<int>& path, const vector<int>* goalDistance = nullptr,
+        vector<int>* expanded = nullptr) {
+        int n = map.rows * map.cols;
+        if ((int)stamp.size() != n) {
+            g.assign(n, 0);
+            parent.assign(n, -1);
+            stamp.assign(n, 0);
+            generation = 0;
+        }
+        if (++generation == 0) {
+            fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        path.clear();
+        if (map.blocked[start] || map.blocked[goal]) return false;
+
+        auto h = [&](int idx) {
+            if (goalDistance) return (*goalDistance)[idx];
+            return abs(idx / map.cols - goal / map.cols) + abs(idx % map.cols - goal % map.cols);
+        };
+        auto greaterF = greater<pair<int, int>>();
+        heap.clear();
+        g[start] = 0;
+        parent[start] = -1;
+        stamp[start] = generation;
+        heap.push_back({ h(start), start });
+
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), greaterF);
+            auto [f, u] = heap.back();
+            heap.pop_back();
+            if (f > g[u] + h(u)) continue;
+            ++expansions;
+            if (expanded) expanded->push_back(u);
+            if (u == goal) {
+                for (int v = goal; v != -1; v = parent[v])
+                    path.push_back(v);
+                reverse(path.begin(), path.end());
+                return true;
+            }
+
+            int r = u / map.cols, c = u % map.cols;
+            int candidates[4] = { r > 0 ? u - map.cols : -1, r + 1 < map.rows ? u + map.cols : -1,
+                                  c > 0 ? u - 1 : -1, c + 1 < map.cols ? u + 1 : -1 };
+            for (int v : candidates) {
+                if (v < 0 || map.blocked[v]) continue;
+                int tentative = g[u] + 1;
+                if (stamp[v] != generation || tentative < g[v]) {
+                    stamp[v] = generation;
+                    g[v] = tentative;
+                    parent[v] = u;
+                    heap.push_back({ tentative + h(v), v });
+                    push_heap(heap.begin(), heap.end(), greaterF);
+                }
+            }
+        }
+        return false;
+    }
+};
+
+// Solves many start/goal pairs at once on a shared WallMap. Workers pull the
+// next agent from an atomic counter and each keeps its own GridSearchState.
+struct MultiAgentResult {
+    vector<vector<int>> paths;
+    int solved = 0;
+    long long expansions = 0;
+    double seconds = 0;
+    unsigned threads = 1;
+};
+
+// goalDistance is passed on to every search, so all agents must share its goal
+MultiAgentResult solveAgents(const WallMap& map, const vector<pair<int, int>>& agents, unsigned threadCount,
+    const vector<int>* goalDistance = nullptr) {
+    MultiAgentResult result;
+    result.paths.resize(agents.size());
+    result.threads = max(1u, threadCount);
+
+    atomic<size_t> next{ 0 };
+    atomic<long long> expansions{ 0 };
+    atomic<int> solved{ 0 };
+    auto worker = [&]() {
+        TraceZone zone("Agent worker");
+        GridSearchState state;
+        for (size_t i = next++; i < agents.size(); i = next++) {
+            if (state.findPath(map, agents[i].first, agents[i].second, result.paths[i], goalDistance))
+                ++solved;
+        }
+        expansions += state.expansions;
+    };
+
+    auto t0 = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (unsigned t = 1; t < result.threads; ++t)
+        workers.emplace_back(worker);
+    worker();
+    for (auto& w : workers)
+        w.join();
+    result.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    result.solved = solved;
+    result.expansions = expansions;
+    return result;
+}
+
+// Connected-component labels of the free cells, kept current under wall edits
+// so "is the goal reachable at all?" is a single comparison. Opening a cell
+// merges its neighbours' components into the largest one; closing a cell runs
+// the BFS searches from its neighbours in lockstep and relabels whichever
+// pieces run dry first, so the largest piece is never walked.
+class GridComponents {
+    int rows = 0, cols = 0;
+    vector<int> labels;      // -1 for walls
+    vector<int> sizes;       // cells per label
+    vector<int> freeLabels;
+    vector<uint32_t> mark;   // stamp-based visited marks for split detection
+    uint32_t markBase = 0;
+
+public:
+    void build(const vector<vector<Cell>>& grid) {
+        rows = grid.size();
+        cols = rows ? grid[0].size() : 0;
+        labels.assign(rows * cols, -1);
+        sizes.clear();
+        freeLabels.clear();
+        mark.assign(rows * cols, 0);
+        markBase = 0;
+        const int unlabeled = -2;
+        for (int i = 0; i < rows * cols; ++i)
+            if (!grid[i / cols][i % cols].isWall) labels[i] = unlabeled;
+        for (int i = 0; i < rows * cols; ++i) {
+            if (labels[i] != unlabeled) continue;
+            int label = newLabel();
+            sizes[label] = flood(i, label);
+        }
+    }
+
+    bool connected(const Cell* a, const Cell* b) const {
+        int la = labels[a->row * cols + a->col];
+        return la != -1 && la == labels[b->row * cols + b->col];
+    }
+
+    int labelOf(int idx) const {
+        return labels[idx];
+    }
+
+    int componentCount() const {
+        return sizes.size() - freeLabels.size();
+    }
+
+    void cellChanged(int row, int col, bool isWall) {
+        int idx = row * cols + col;
+        if (isWall) closeCell(idx);
+        else openCell(idx);
+    }
+
+private:
+    int newLabel() {
+        if (!freeLabels.empty()) {
+            int label = freeLabels.back();
+            freeLabels.pop_back();
+            sizes[label] = 0;
+            return label;
+        }
+        sizes.push_back(0);
+        return sizes.size() - 1;
+    }
+
+    void releaseLabel(int label) {
+        sizes[label] = 0;
+        freeLabels.push_back(label);
+    }
+
+    int neighborsOf(int idx, int out[4]) const {
+        int r = idx / cols, c = idx % cols, n = 0;
+        if (r > 0) out[n++] = idx - cols;
+        if (r + 1 < rows) out[n++] = idx + cols;
+        if (c > 0) out[n++] = idx - 1;
+        if (c + 1 < cols) out[n++] = idx + 1;
+        return n;
+    }
+
+    // Relabels every free cell connected to `from`; returns the cell count
+    int flood(int from, int label) {
+        int count = 0;
+        vector<int> stack = { from };
+        labels[from] = label;
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            ++count;
+            int nbrs[4];
+            int n = neighborsOf(u, nbrs);
+            for (int i = 0; i < n; ++i) {
+                int v = nbrs[i];
+                if (labels[v] != -1 && labels[v] != label) {
+                    labels[v] = label;
+                    stack.push_back(v);
+                }
+            }
+        }
+        return count;
+    }
+
+    void openCell(int idx) {
+        int nbrs[4];
+        int n = neighborsOf(idx, nbrs);
+        int target = -1;
+        for (int i = 0; i < n; ++i) {
+            int l = labels[nbrs[i]];
+            if (l != -1 && (target == -1 || sizes[l] > sizes[target])) target = l;
+        }
+        if (target == -1) {
+            target = newLabel();
+        }
+        labels[idx] = target;
+        ++sizes[target];
+
+        for (int i = 0; i < n; ++i) {
+            int l = labels[nbrs[i]];
+            if (l == -1 || l == target) continue;
+            sizes[target] += flood(nbrs[i], target);
+            releaseLabel(l);
+        }
+    }
+
+    void closeCell(int idx) {
+        int label = labels[idx];
+        labels[idx] = -1;
+        if (label == -1) return;
+        --sizes[label];
+
+        int nbrs[4], seeds[4];
+        int n = neighborsOf(idx, nbrs), k = 0;
+        for (int i = 0; i < n; ++i)
+            if (labels[nbrs[i]] != -1) seeds[k++] = nbrs[i];
+        if (k == 0) {
+            releaseLabel(label);
+            return;
+        }
+        if (k == 1) return;
+
+        // One search per seed; searches that meet are joined into one group
+        if (markBase > numeric_limits<uint32_t>::max() - 4) {
+            fill(mark.begin(), mark.end(), 0);
+            markBase = 0;
+        }
+        uint32_t base = markBase + 1;
+        markBase += k;
+        int group[4];
+        bool dead[4] = { false, false, false, false };
+        vector<int> seen[4];
+        size_t head[4] = { 0, 0, 0, 0 };
+        auto find = [&](int s) {
+            while (group[s] != s) s = group[s];
+            return s;
+        };
+        for (int s = 0; s < k; ++s) {
+            group[s] = s;
+            mark[seeds[s]] = base + s;
+            seen[s].push_back(seeds[s]);
+        }
+
+        auto liveGroups = [&]() {
+            int live = 0;
+            for (int s = 0; s < k; ++s)
+                if (find(s) == s && !dead[s]) ++live;
+            return live;
+        };
+        while (liveGroups() > 1) {
+
+            for (int s = 0; s < k; ++s) {
+                int root = find(s);
+                if (dead[root]) continue;
+
+                if (head[s] < seen[s].size()) {
+                    int u = seen[s][head[s]++];
+                    int adj[4];
+                    int m = neighborsOf(u, adj);
+                    for (int i = 0; i < m; ++i) {
+                        int v = adj[i];
+                        if (labels[v] == -1) continue;
+                        if (mark[v] >= base) {
+                            int other = find(mark[v] - base);
+                            if (other != find(s)) group[other] = find(s);
+                            continue;
+                        }
+                        mark[v] = base + s;
+                        seen[s].push_back(v);
+                    }
+                    continue;
+                }
+
+                // A group with no frontier left is cut off: give it its own label,
+                // unless meetings earlier in this pass already left it the only one
+                bool dry = true;
+                for (int t = 0; t < k; ++t)
+                    if (find(t) == root && head[t] < seen[t].size()) dry = false;
+                if (!dry) continue;
+                if (liveGroups() <= 1) break;
+                int split = newLabel();
+                for (int t = 0; t < k; ++t) {
+                    if (find(t) != root) continue;
+                    for (int v : seen[t]) labels[v] = split;
+                    sizes[split] += seen[t].size();
+                    sizes[label] -= seen[t].size();
+                }
+                dead[root] = true;
+                break;
+            }
+        }
+    }
+};
+
+// Multi-source BFS over the whole grid on bitsets. Each row of the free-cell
+// mask is packed into 64-bit words, and one BFS level costs a few shifts, ORs
+// and ANDs per word, so a single operation advances up to 64 cells. The row
+// loops are plain word arithmetic that compilers vectorize. Each level only
+// scans the words around the frontier's span in each row. This pays off on
+// wide fronts; a thin diagonal front costs about as much as a queue BFS.
+class BitDistanceField {
+    int rows = 0, cols = 0, words = 0; // words per row
+    vector<uint64_t> open, seen, frontier, next;
+    vector<int> spanFirst, spanLast; // frontier words per row, empty if first > last
+    vector<int> nextFirst, nextLast;
+
+public:
+    vector<int> distance; // steps from the nearest source, -1 if unreachable
+    int maxDistance = 0;
+    int reached = 0;
+
+    void compute(const WallMap& map, const vector<int>& sources) {
+        rows = map.rows;
+        cols = map.cols;
+        words = (cols + 63) / 64;
+        size_t total = size_t(rows) * words;
+        open.assign(total, 0);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                if (!map.blocked[r * cols + c])
+                    open[r * words + c / 64] |= uint64_t(1) << (c % 64);
+        seen.assign(total, 0);
+        frontier.assign(total, 0);
+        next.assign(total, 0);
+        spanFirst.assign(rows, words);
+        spanLast.assign(rows, -1);
+        nextFirst.assign(rows, words);
+        nextLast.assign(rows, -1);
+        distance.assign(rows * cols, -1);
+        maxDistance = 0;
+        reached = 0;
+
+        int top = rows, bottom = -1; // rows holding the frontier
+        for (int source : sources) {
+            if (map.blocked[source] || distance[source] == 0) continue;
+            int r = source / cols, c = source % cols;
+            frontier[r * words + c / 64] |= uint64_t(1) << (c % 64);
+            seen[r * words + c / 64] |= uint64_t(1) << (c % 64);
+            spanFirst[r] = min(spanFirst[r], c / 64);
+            spanLast[r] = max(spanLast[r], c / 64);
+            distance[source] = 0;
+            ++reached;
+            top = min(top, r);
+            bottom = max(bottom, r);
+        }
+
+        for (int level = 1; top <= bottom; ++level) {
+            int nextTop = rows, nextBottom = -1;
+            int first = max(0, top - 1), last = min(rows - 1, bottom + 1);
+            for (int r = first; r <= last; ++r) {
+                // Words next to a frontier word, in this row or the ones beside it
+                int from = spanFirst[r] - 1, to = spanLast[r] + 1;
+                if (r > 0) {
+                    from = min(from, spanFirst[r - 1]);
+                    to = max(to, spanLast[r - 1]);
+                }
+                if (r + 1 < rows) {
+                    from = min(from, spanFirst[r + 1]);
+                    to = max(to, spanLast[r + 1]);
+                }
+                from = max(from, 0);
+                to = min(to, words - 1);
+
+                const uint64_t* here = &frontier[r * words];
+                const uint64_t* above = r > 0 ? here - words : nullptr;
+                const uint64_t* below = r + 1 < rows ? here + words : nullptr;
+                for (int k = from; k <= to; ++k) {
+                    // Bit i is column i: left shifts move right, carries cross words
+                    uint64_t spread = (here[k] << 1) | (here[k] >> 1);
+                    if (k > 0) spread |= here[k - 1] >> 63;
+                    if (k + 1 < words) spread |= here[k + 1] << 63;
+                    if (above) spread |= above[k];
+                    if (below) spread |= below[k];
+                    uint64_t fresh = spread & open[r * words + k] & ~seen[r * words + k];
+                    next[r * words + k] = fresh;
+                    if (!fresh) continue;
+                    // Only this row's cells are masked by this row of seen,
+                    // so marking them now cannot hide cells from other rows
+                    seen[r * words + k] |= fresh;
+                    reached += popcount(fresh);
+                    int* row = &distance[r * cols + k * 64];
+                    for (; fresh; fresh &= fresh - 1)
+                        row[countr_zero(fresh)] = level;
+                    nextFirst[r] = min(nextFirst[r], k);
+                    nextLast[r] = k;
+                }
+                if (nextFirst[r] <= nextLast[r]) {
+                    nextTop = min(nextTop, r);
+                    nextBottom = r;
+                }
+                // Row r - 1 of the frontier has been read for the last time
+                if (r > first) clearFrontierRow(r - 1);
+            }
+            clearFrontierRow(last);
+            swap(frontier, next);
+            swap(spanFirst, nextFirst);
+            swap(spanLast, nextLast);
+            if (nextBottom >= 0) maxDistance = level;
+            top = nextTop;
+            bottom = nextBottom;
+        }
+    }
+
+private:
+    // Zeroes the frontier's words in the row, so the buffer is all zeros when
+    // it is written as next again
+    void clearFrontierRow(int r) {
+        if (spanFirst[r] > spanLast[r]) return;
+        fill(frontier.begin() + r * words + spanFirst[r], frontier.begin() + r * words + spanLast[r] + 1, 0);
+        spanFirst[r] = words;
+        spanLast[r] = -1;
+    }
+};
+
+// Blue at 0 through green to red at 1
+Color heatColor(float t, Uint8 alpha = 255) {
+    t = clamp(t, 0.f, 1.f);
+    float r = t < 0.5f ? 0 : 2 * t - 1;
+    float g = t < 0.5f ? 2 * t : 2 - 2 * t;
+    float b = t < 0.5f ? 1 - 2 * t : 0;
+    return Color(static_cast<Uint8>(r * 255), static_cast<Uint8>(g * 255), static_cast<Uint8>(b * 255), alpha);
+}
+
+// Mud is brown, anything dearer is water
+Color terrainColor(int cost) {
+    return cost <= 3 ? Color(190, 150, 100) : Color(70, 170, 200);
+}
+
+// Evenly spread, saturated colours for overlays that need many distinct hues
+Color paletteColor(int i, Uint8 alpha = 255) {
+    float hue = fmod(i * 0.618034f, 1.f) * 6.f;
+    float x = 1.f - fabs(fmod(hue, 2.f) - 1.f);
+    float r = 0, g = 0, b = 0;
+    switch (static_cast<int>(hue)) {
+    case 0: r = 1; g = x; break;
+    case 1: r = x; g = 1; break;
+    case 2: g = 1; b = x; break;
+    case 3: g = x; b = 1; break;
+    case 4: r = x; b = 1; break;
+    default: r = 1; b = x; break;
+    }
+    return Color(static_cast<Uint8>(r * 255), static_cast<Uint8>(g * 255), static_cast<Uint8>(b * 255), alpha);
+}
+
+// -- MOVING AI BENCHMARKS --
+// Grid maps and scenarios in the formats of the Moving AI Lab benchmark sets
+// (movingai.com/benchmarks), so runs can be compared with published numbers.
+// Maps mark passable terrain with '.', 'G' and 'S'; everything else (trees,
+// water, out of bounds) is a wall.
+struct Scenario {
+    int start, goal;   // cell indices
+    float optimal;     // reference length for 8-connected octile moves
+};
+
+bool loadMovingAIMap(const string& path, WallMap& map, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = "Cannot open " + path;
+        return false;
+    }
+    string word, type;
+    int height = 0, width = 0;
+    while (in >> word && word != "map") {
+        if (word == "type") in >> type;
+        else if (word == "height") in >> height;
+        else if (word == "width") in >> width;
+    }
+    if (word != "map" || height <= 0 || width <= 0) {
+        error = path + ": missing height, width or map section";
+        return false;
+    }
+
+    map.rows = height;
+    map.cols = width;
+    map.blocked.assign(height * width, 1);
+    string line;
+    getline(in, line); // rest of the "map" line
+    for (int r = 0; r < height; ++r) {
+        if (!getline(in, line) || (int)line.size() < width) {
+            error = path + ": row " + to_string(r) + " is missing or short";
+            return false;
+        }
+        for (int c = 0; c < width; ++c)
+            map.blocked[r * width + c] = !(line[c] == '.' || line[c] == 'G' || line[c] == 'S');
+    }
+    return true;
+}
+
+// Scenario lines: bucket, map name, map width and height, start x/y, goal
+// x/y, optimal length. x is the column and y the row.
+bool loadMovingAIScenarios(const string& path, const WallMap& map, vector<Scenario>& scenarios, string& error) {
+    ifstream in(path);
+    if (!in) {
+        error = "Cannot open " + path;
+        return false;
+    }
+    scenarios.clear();
+    string line;
+    int lineNumber = 0;
+    while (getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line.rfind("version", 0) == 0) continue;
+        istringstream fields(line);
+        int bucket, width, height, sx, sy, gx, gy;
+        string mapName;
+        float optimal;
+        if (!(fields >> bucket >> mapName >> width >> height >> sx >> sy >> gx >> gy >> optimal)) {
+            error = path + ":" + to_string(lineNumber) + ": malformed scenario";
+            return false;
+        }
+        if (width != map.cols || height != map.rows) {
+            error = path + ":" + to_string(lineNumber) + ": scenario is for a " + to_string(width) + "x" +
+                to_string(height) + " map";
+            return false;
+        }
+        if (sx < 0 || sx >= width || gx < 0 || gx >= width || sy < 0 || sy >= height || gy < 0 || gy >= height) {
+            error = path + ":" + to_string(lineNumber) + ": cell outside the map";
+            return false;
+        }
+        scenarios.push_back({ sy * width + sx, gy * width + gx, optimal });
+    }
+    return true;
+}
+
+vector<vector<Cell>> cellsFromWalls(const WallMap& map) {
+    vector<vector<Cell>> cells(map.rows, vector<Cell>(map.cols));
+    for (int r = 0; r < map.rows; ++r)
+        for (int c = 0; c < map.cols; ++c) {
+            cells[r][c] = { r, c };
+            cells[r][c].isWall = map.blocked[r * map.cols + c];
+        }
+    return cells;
+}
+
+// -- GRID MOVEMENT --
+// How the A* view steps between cells. Diagonal steps cost sqrt(2) and never
+// squeeze between two walls; without corner cutting they may not brush past
+// a single wall either.
+enum class Movement { Four, NoCornerCutting, CutCorners };
+
+// Unit: every step costs the same. Terrain: a step costs the Cell::cost of
+// the cell it enters, times sqrt(2) on diagonals.
+enum class CostModel { Unit, Terrain };
+
+constexpr float diagonalCost = 1.41421356f;
+
+const char* movementName(Movement movement) {
+    switch (movement) {
+    case Movement::Four: return "4-connected";
+    case Movement::NoCornerCutting: return "8-connected, no corner cutting";
+    default: return "8-connected, corner cutting";
+    }
+}
+
+// Open list for integral f values that never decrease, which A* gets from
+// integer step costs and a consistent heuristic. Push and pop are O(1). The
+// newest cell of the lowest bucket comes out first, which among equal f
+// favours the cells closest to the goal.
+class BucketQueue {
+    pmr::vector<pmr::vector<Cell*>> buckets;
+    size_t lowest = 0;
+public:
+    explicit BucketQueue(pmr::memory_resource* memory) : buckets(memory) {}
+
+    void push(Cell* cell, float f) {
+        size_t bucket = static_cast<size_t>(f);
+        if (bucket >= buckets.size())
+            buckets.resize(bucket + 1);
+        buckets[bucket].push_back(cell);
+        lowest = min(lowest, bucket);
+    }
+
+    bool empty() {
+        while (lowest < buckets.size() && buckets[lowest].empty())
+            ++lowest;
+        return lowest == buckets.size();
+    }
+
+    // Only after empty() returned false
+    Cell* pop() {
+        Cell* cell = buckets[lowest].back();
+        buckets[lowest].pop_back();
+        return cell;
+    }
+};
+
+// Binary heap for the modes whose f values are not integers
+class HeapQueue {
+    struct Node {
+        Cell* cell;
+        float f;
+        bool operator>(const Node& other) const { return f > other.f; }
+    };
+    priority_queue<Node, pmr::vector<Node>, greater<Node>> heap;
+public:
+    explicit HeapQueue(pmr::memory_resource* memory) : heap(greater<Node>{}, pmr::vector<Node>(memory)) {}
+
+    void push(Cell* cell, float f) {
+        heap.push({ cell, f });
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    Cell* pop() {
+        Cell* cell = heap.top().cell;
+        heap.pop();
+        return cell;
+    }
+};
+
+class AStarVisualizer {
+public:
+    struct SearchResult {
+        vector<int> pathCells; // goal first
+        vector<int> visitedCells;
+        bool found = false;
+        float cost = 0;
+        LPAStarPlanner planner; // only set by a priming run
+    };
+
+private:
+    // The default grid; imported maps keep to the same screen area
+    static constexpr int areaWidth = 80 * 30, areaHeight = 50 * 30;
+    int rows = 50;
+    int cols = 80;
+    int cellSize = 30;
+    vector<vector<Cell>> grid;
+    Cell* start = nullptr;
+    Cell* end = nullptr;
+    bool running = false;
+    bool pathFound = false;
+    Movement movement = Movement::Four;
+    int brush = 0; // terrain cost painted by left clicks, 0 paints walls
+    // After a 4-connected search, wall and terrain edits repair the path
+    // through LPA* instead of rerunning A*. The planner is primed in the
+    // background on the first edit, so searches never pay for it.
+    LPAStarPlanner planner;
+    bool replanning = false;
+    bool priming = false; // the background run is priming the planner
+    vector<int> pathCells;
+    vector<int> visitedCells;
+    HierarchicalPlanner hierarchy;
+    bool showClusters = false;
+    vector<vector<int>> agentPaths;
+    unsigned agentSeed = 1;
+    vector<Scenario> scenarios; // from an imported .scen file
+    size_t nextScenario = 0;
+    // Distance field overlay: BFS steps from the start and any extra sources
+    BitDistanceField field;
+    bool showField = false;
+    vector<int> fieldSources; // Shift+click cells, besides the start
+    GridComponents components;
+    bool showComponents = false;
+    // The finished search replayed one expanded cell per step: per cell 0
+    // untouched, 1 expanded, 2 on the path (all set by the last step)
+    ScrubBar scrubBar;
+    bool dirty = true;
+    Text statusText;
+
+    // A* and LPA* priming run in the background on a copy of the grid; any
+    // edit to the grid abandons the run
+    BackgroundRun<SearchResult> search;
+    int shownProgress = -1;
+    // Shared with the job using it; a cancelled job may still be unwinding
+    // when the next search starts, which then gets a fresh arena instead
+    shared_ptr<ScratchArena> scratch = make_shared<ScratchArena>();
+    //new member variable for reset buuton
+    RectangleShape restartButton;
+    Text restartButtonText;
+    RectangleShape exitbutton;
+    Text exitbuttonText;
+    Font font;
+public:
+    AStarVisualizer() {
+        grid.resize(rows, vector<Cell>(cols));
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                grid[r][c] = { r, c };
+        components.build(grid);
+
+        font.loadFromFile("arial.ttf");
+        restartButton.setSize({ 150, 35 });
+        restartButton.setFillColor(Color::Blue);
+        restartButton.setPosition(700, 20);
+
+        restartButtonText.setFont(font);
+        restartButtonText.setCharacterSize(18);
+        restartButtonText.setFillColor(Color::White);
+        restartButtonText.setString("Restart");
+        restartButtonText.setPosition(730, 25);
+
+        exitbutton.setSize({ 150, 35 });
+        exitbutton.setFillColor(Color::Red);
+        exitbutton.setPosition(1025, 20);
+
+        exitbuttonText.setFont(font);
+        exitbuttonText.setCharacterSize(18);
+        exitbuttonText.setFillColor(Color::White);
+        exitbuttonText.setString("Exit");
+        exitbuttonText.setPosition(1040, 25);
+
+        statusText.setFont(font);
+        statusText.setCharacterSize(18);
+        statusText.setFillColor(Color::Black);
+        statusText.setPosition(1200, 25);
+    }
+
+    void reset() {
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                grid[r][c] = { r, c }; 
+            }
+        }
+        start = nullptr;
+        end = nullptr;
+        running = false;
+        pathFound = false;
+        replanning = false;
+        hierarchy.invalidate();
+        components.build(grid);
+        agentPaths.clear();
+        pathCells.clear();
+        visitedCells.clear();
+        showField = false;
+        fieldSources.clear();
+        scrubBar.clear();
+        statusText.setString("");
+        search.cancel();
+        dirty = true;
+    }
+
+    void cancelRun() {
+        if (!search.isRunning()) return;
+        search.cancel();
+        statusText.setString("Search cancelled");
+    }
+
+    // Replaces the grid with an imported map, shrinking the cells so it fits
+    void loadMap(const WallMap& map) {
+        rows = map.rows;
+        cols = map.cols;
+        cellSize = max(1, min(areaWidth / cols, areaHeight / rows));
+        grid.assign(rows, vector<Cell>(cols));
+        scenarios.clear();
+        nextScenario = 0;
+        reset();
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                grid[r][c].isWall = map.blocked[r * cols + c];
+        components.build(grid);
+        statusText.setString("Loaded " + to_string(cols) + "x" + to_string(rows) + " map");
+    }
+
+    void loadScenarios(vector<Scenario> list) {
+        scenarios = move(list);
+        nextScenario = 0;
+        statusText.setString(to_string(scenarios.size()) + " scenarios - press N to step through them");
+        dirty = true;
+    }
+
+    // N: puts the next scenario's start and goal on the grid
+    void showNextScenario() {
+        dirty = true;
+        if (scenarios.empty()) {
+            statusText.setString("No scenarios loaded (start with --map and --scen)");
+            return;
+        }
+        const Scenario& s = scenarios[nextScenario];
+        clearSearch();
+        replanning = false;
+        start = &grid[s.start / cols][s.start % cols];
+        end = &grid[s.goal / cols][s.goal % cols];
+        stringstream ss;
+        ss << "Scenario " << nextScenario + 1 << "/" << scenarios.size() << ", octile optimum " << s.optimal;
+        statusText.setString(ss.str());
+        nextScenario = (nextScenario + 1) % scenarios.size();
+    }
+
+    bool isBusy() const {
+        return search.isRunning();
+    }
+
+    void update() {
+        SearchResult result;
+        if (search.poll(result)) {
+            pathCells = move(result.pathCells);
+            visitedCells = move(result.visitedCells);
+            pathFound = result.found;
+            for (int idx : visitedCells)
+                grid[idx / cols][idx % cols].isVisited = true;
+            for (int idx : pathCells)
+                grid[idx / cols][idx % cols].isPath = true;
+            recordSearch();
+            // A finished search leaves the planner unset until the first edit
+            planner = move(result.planner);
+            if (planner.isReady()) planner.rebind(grid);
+            replanning = movement == Movement::Four;
+            stringstream ss;
+            if (priming)
+                ss << (pathFound ? "Replanned: " : "No path: ") << visitedCells.size()
+                    << " cells expanded priming LPA* - later edits repair incrementally";
+            else if (pathFound)
+                ss << "Path found, cost " << fixed << setprecision(1) << result.cost
+                    << (replanning ? " - wall edits now replan incrementally" : "");
+            else
+                ss << "No path";
+            statusText.setString(ss.str());
+            priming = false;
+            dirty = true;
+        }
+        else if (search.isRunning()) {
+            int percent = static_cast<int>(search.progress() * 100);
+            if (percent != shownProgress) {
+                shownProgress = percent;
+                statusText.setString((priming ? "Priming LPA*... " : "Searching... ") + to_string(percent) + "%");
+                dirty = true;
+            }
+        }
+    }
+
+    bool isRestartButtonClicked(Vector2f pos) {
+        return restartButton.getGlobalBounds().contains(pos);
+    }
+
+    bool isExitButtonClicked(Vector2f pos) {
+        return exitbutton.getGlobalBounds().contains(pos);
+    }
+
+    bool consumeDirty() {
+        bool wasDirty = dirty | scrubBar.consumeChanged();
+        dirty = false;
+        return wasDirty;
+    }
+
+    ScrubBar& scrubber() {
+        return scrubBar;
+    }
+
+    void draw(Canvas& window) {
+        // One quad per cell in a single draw; imported maps have a lot of them.
+        // Cells keep a 1px gap unless they are too small to spare it.
+        VertexArray cells(Quads, rows * cols * 4);
+        float side = cellSize > 3 ? cellSize - 1 : cellSize;
+        const vector<int32_t>* recorded = scrubBar.isScrubbing() ? &scrubBar.shown() : nullptr;
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) {
+                Cell& cell = grid[r][c];
+                int idx = r * cols + c;
+                int mark = recorded ? (*recorded)[idx] : cell.isPath ? 2 : cell.isVisited ? 1 : 0;
+                Color color;
+                if (&cell == start) color = Color::Green;
+                else if (&cell == end) color = Color::Red;
+                else if (cell.isWall) color = Color(50, 50, 50);
+                else if (mark == 2) color = Color::Yellow;
+                else if (showField && find(fieldSources.begin(), fieldSources.end(), idx) != fieldSources.end())
+                    color = Color(255, 140, 0);
+                else if (showField && field.distance[idx] >= 0)
+                    color = heatColor(float(field.distance[idx]) / max(field.maxDistance, 1));
+                else if (mark == 1) color = Color(100, 100, 255);
+                else if (cell.cost > 1) color = terrainColor(cell.cost);
+                else if (showComponents) color = paletteColor(components.labelOf(idx));
+                else color = Color::White;
+
+                float x = c * cellSize, y = r * cellSize;
+                Vertex* quad = &cells[(r * cols + c) * 4];
+                quad[0] = Vertex({ x, y }, color);
+                quad[1] = Vertex({ x + side, y }, color);
+                quad[2] = Vertex({ x + side, y + side }, color);
+                quad[3] = Vertex({ x, y + side }, color);
+            }
+        }
+        window.draw(cells);
+        if (showClusters && hierarchy.isBuilt())
+            drawClusterOverlay(window);
+        if (!agentPaths.empty())
+            drawAgentPaths(window);
+        window.draw(restartButton);
+        window.draw(restartButtonText);
+        window.draw(exitbutton);
+        window.draw(exitbuttonText);
+        window.draw(statusText);
+        scrubBar.draw(window);
+    }
+
+
+    void handleClick(Vector2f pos) {
+        int row = pos.y / cellSize;
+        int col = pos.x / cellSize;
+        if (row >= 0 && row < rows && col >= 0 && col < cols) {
+            dirty = true;
+            scrubBar.toLive(); // edits apply to the grid as it is now
+            if (Keyboard::isKeyPressed(Keyboard::LShift) || Keyboard::isKeyPressed(Keyboard::RShift)) {
+                toggleFieldSource(row * cols + col);
+                return;
+            }
+            Cell* clicked = &grid[row][col];
+            Cell* oldStart = start;
+            Cell* oldEnd = end;
+            bool wasWall = clicked->isWall;
+            int oldCost = clicked->cost;
+            if (Mouse::isButtonPressed(Mouse::Left)) {
+                if (!start) start = clicked;
+                else if (!end && clicked != start) end = clicked;
+                else if (clicked != start && clicked != end) {
+                    if (brush == 0) clicked->isWall = !clicked->isWall;
+                    else if (!clicked->isWall) clicked->cost = clicked->cost == brush ? 1 : brush;
+                }
+            }
+            else if (Mouse::isButtonPressed(Mouse::Right)) {
+                if (clicked == start) start = nullptr;
+                if (clicked == end) end = nullptr;
+                clicked->isWall = false;
+                clicked->cost = 1;
+            }
+            bool costChanged = clicked->cost != oldCost && !clicked->isWall;
+
+            if (clicked->isWall != wasWall)
+                components.cellChanged(row, col, clicked->isWall);
+            if (clicked->isWall != wasWall && hierarchy.isBuilt())
+                hierarchy.cellChanged(row, col);
+            if (clicked->isWall != wasWall)
+                agentPaths.clear(); // solved against the old walls
+            if (search.isRunning() && (clicked->isWall != wasWall || costChanged || start != oldStart || end != oldEnd))
+                cancelRun(); // searching a grid that no longer exists
+
+            if (start != oldStart || end != oldEnd) {
+                // The planner is tied to one start/goal pair
+                replanning = false;
+            }
+            else if (replanning && (clicked->isWall != wasWall || costChanged)) {
+                replan(row, col);
+            }
+            if (showField && (clicked->isWall != wasWall || start != oldStart))
+                computeField();
+        }
+    }
+
+    // Dragging with a terrain brush paints every free cell the mouse crosses
+    void paintTerrain(Vector2f pos) {
+        int row = pos.y / cellSize;
+        int col = pos.x / cellSize;
+        if (brush == 0 || row < 0 || row >= rows || col < 0 || col >= cols) return;
+        Cell* cell = &grid[row][col];
+        if (cell == start || cell == end || cell->isWall || cell->cost == brush) return;
+        cell->cost = brush;
+        dirty = true;
+        scrubBar.toLive();
+        if (search.isRunning()) cancelRun();
+        if (replanning) replan(row, col);
+    }
+
+    // T: walls, mud, water
+    void cycleBrush() {
+        dirty = true;
+        brush = brush == 0 ? 3 : brush == 3 ? 8 : 0;
+        statusText.setString(brush == 0 ? "Brush: walls" : brush == 3 ? "Brush: mud (cost 3)" : "Brush: water (cost 8)");
+    }
+
+    // G: 4-connected, then 8-connected without and with corner cutting
+    void cycleMovement() {
+        dirty = true;
+        movement = Movement((int(movement) + 1) % 3);
+        clearSearch();
+        replanning = false;
+        statusText.setString(string("Movement: ") + movementName(movement));
+    }
+
+    // D: shows BFS distances from the start and the Shift+clicked sources
+    void toggleDistanceField() {
+        dirty = true;
+        showField = !showField;
+        if (showField)
+            computeField();
+    }
+
+    // Shift+M: agents from random cells all head for the end cell. They share
+    // one BFS field from the goal as an exact heuristic, so each A* expands
+    // little beyond its own path; the Manhattan run is there to compare.
+    void runAgentsToGoal(int count = 200) {
+        dirty = true;
+        if (!end) {
+            statusText.setString("Set an end cell first");
+            return;
+        }
+        WallMap map(grid);
+        int goal = end->row * cols + end->col;
+        vector<pair<int, int>> agents;
+        mt19937 rng(agentSeed++);
+        uniform_int_distribution<int> pick(0, rows * cols - 1);
+        for (int tries = 0; (int)agents.size() < count && tries < count * 50; ++tries) {
+            int cell = pick(rng);
+            if (!map.blocked[cell] && components.labelOf(cell) == components.labelOf(goal))
+                agents.push_back({ cell, goal });
+        }
+        if (agents.empty()) {
+            statusText.setString("No free cells can reach the end cell");
+            return;
+        }
+
+        ScopedRun run("Multi-agent A*, exact h");
+        auto t0 = chrono::steady_clock::now();
+        BitDistanceField goalField;
+        goalField.compute(map, { goal });
+        auto fieldUs = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+        MultiAgentResult exact = solveAgents(map, agents, thread::hardware_concurrency(), &goalField.distance);
+        MultiAgentResult manhattan = solveAgents(map, agents, thread::hardware_concurrency());
+        perf.expansions += exact.expansions;
+        agentPaths = move(exact.paths);
+        stringstream ss;
+        ss << exact.solved << " agents to the goal: " << exact.expansions << " expansions with exact h ("
+            << manhattan.expansions << " with Manhattan), goal field in " << fieldUs << " us";
+        statusText.setString(ss.str());
+    }
+
+    void runAStar() {
+        dirty = true;
+        if (!start || !end) {
+            statusText.setString("Set a start and an end cell first");
+            return;
+        }
+        clearSearch();
+        if (!components.connected(start, end)) {
+            statusText.setString("No path: start and end are in different regions");
+            replanning = false;
+            return;
+        }
+
+        replanning = false;
+        priming = false;
+        shownProgress = -1;
+        statusText.setString("Searching...");
+        vector<vector<Cell>> snapshot = grid;
+        int startIdx = start->row * cols + start->col;
+        int goalIdx = end->row * cols + end->col;
+        // Unpainted grids keep the unit-cost search
+        CostModel costs = CostModel::Unit;
+        for (auto& row : grid)
+            for (auto& cell : row)
+                if (!cell.isWall && cell.cost != 1) costs = CostModel::Terrain;
+        if (scratch.use_count() > 1)
+            scratch = make_shared<ScratchArena>();
+        search.start([snapshot, startIdx, goalIdx, movement = movement, costs, arena = scratch](const CancelToken& token) mutable {
+            return searchGrid(snapshot, startIdx, goalIdx, movement, costs, *arena, token);
+        });
+    }
+
+    // HPA* query; the cluster abstraction is built on first use and then kept
+    // up to date by handleClick
+    void runHierarchical() {
+        dirty = true;
+        if (!start || !end) {
+            statusText.setString("Set a start and an end cell first");
+            return;
+        }
+        clearSearch();
+        replanning = false;
+        if (!components.connected(start, end)) {
+            statusText.setString("No path: start and end are in different regions");
+            return;
+        }
+
+        ScopedRun run("HPA*");
+        auto t0 = chrono::steady_clock::now();
+        if (!hierarchy.isBuilt()) {
+            TraceZone zone("HPA* build");
+            hierarchy.build(grid);
+        }
+        pathCells = hierarchy.findPath(start, end);
+        perf.expansions += hierarchy.abstractExpanded;
+        auto us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+
+        pathFound = !pathCells.empty();
+        for (int idx : pathCells)
+            grid[idx / cols][idx % cols].isPath = true;
+        statusText.setString(string(pathFound ? "HPA*: " : "HPA* no path: ") +
+            to_string(hierarchy.abstractExpanded) + " abstract nodes, " +
+            to_string(hierarchy.refinedCells) + " refined cells, " + to_string(us) + " us");
+    }
+
+    // Solves a batch of random start/goal pairs concurrently on a snapshot of
+    // the walls and overlays every path
+    void runAgents(int count = 200) {
+        dirty = true;
+        WallMap map(grid);
+        vector<int> freeCells;
+        for (int i = 0; i < rows * cols; ++i)
+            if (!map.blocked[i]) freeCells.push_back(i);
+        if (freeCells.size() < 2) {
+            statusText.setString("Not enough free cells for agents");
+            return;
+        }
+
+        mt19937 rng(agentSeed++);
+        uniform_int_distribution<size_t> pick(0, freeCells.size() - 1);
+        // Pairs in different components are known failures and never dispatched
+        vector<pair<int, int>> agents;
+        int unreachable = 0;
+        for (int i = 0; i < count; ++i) {
+            int a = freeCells[pick(rng)], b = freeCells[pick(rng)];
+            if (components.labelOf(a) == components.labelOf(b)) agents.push_back({ a, b });
+            else ++unreachable;
+        }
+
+        ScopedRun run("Multi-agent A*");
+        MultiAgentResult result = solveAgents(map, agents, thread::hardware_concurrency());
+        perf.expansions += result.expansions;
+        agentPaths = move(result.paths);
+        stringstream ss;
+        // Throughput only counts the searches that actually ran
+        ss << result.solved << "/" << agents.size() << " agents solved, " << unreachable << " more unreachable, on "
+            << result.threads << " threads: "
+            << static_cast<long long>(agents.size() / max(result.seconds, 1e-9)) << " searches/s, "
+            << result.expansions << " expansions";
+        statusText.setString(ss.str());
+    }
+
+    void toggleComponentOverlay() {
+        dirty = true;
+        showComponents = !showComponents;
+        if (showComponents)
+            statusText.setString(to_string(components.componentCount()) + " connected regions");
+    }
+
+    void toggleClusterOverlay() {
+        dirty = true;
+        showClusters = !showClusters;
+        if (showClusters && !hierarchy.isBuilt())
+            hierarchy.build(grid);
+    }
+
+private:
+    // Cluster borders, entrance cells, and a red tint proportional to the cells
+    // each cluster touched during the last query or rebuild
+    void drawClusterOverlay(Canvas& window) {
+        int maxWork = 1;
+        for (int w : hierarchy.clusterWork) maxWork = max(maxWork, w);
+
+        VertexArray tint(Quads);
+        VertexArray borders(Lines);
+        VertexArray entrances(Quads);
+        for (int i = 0; i < hierarchy.clusterCount(); ++i) {
+            IntRect bounds = hierarchy.clusterBounds(i);
+            float x = bounds.left * cellSize, y = bounds.top * cellSize;
+            float w = bounds.width * cellSize, h = bounds.height * cellSize;
+
+            Color heat(255, 0, 0, static_cast<Uint8>(150 * hierarchy.clusterWork[i] / maxWork));
+            tint.append(Vertex({ x, y }, heat));
+            tint.append(Vertex({ x + w, y }, heat));
+            tint.append(Vertex({ x + w, y + h }, heat));
+            tint.append(Vertex({ x, y + h }, heat));
+
+            Color line(0, 150, 0);
+            borders.append(Vertex({ x, y }, line));
+            borders.append(Vertex({ x + w, y }, line));
+            borders.append(Vertex({ x, y }, line));
+            borders.append(Vertex({ x, y + h }, line));
+
+            for (int e : hierarchy.entrancesOf(i)) {
+                float ex = (e % cols) * cellSize + cellSize / 4.f;
+                float ey = (e / cols) * cellSize + cellSize / 4.f;
+                float es = cellSize / 2.f;
+                Color orange(255, 140, 0);
+                entrances.append(Vertex({ ex, ey }, orange));
+                entrances.append(Vertex({ ex + es, ey }, orange));
+                entrances.append(Vertex({ ex + es, ey + es }, orange));
+                entrances.append(Vertex({ ex, ey + es }, orange));
+            }
+        }
+        window.draw(tint);
+        window.draw(borders);
+        window.draw(entrances);
+    }
+
+    void drawAgentPaths(Canvas& window) {
+        VertexArray lines(Lines);
+        float half = cellSize / 2.f;
+        for (size_t a = 0; a < agentPaths.size(); ++a) {
+            Color color = paletteColor(a, 180);
+            const vector<int>& path = agentPaths[a];
+            for (size_t i = 1; i < path.size(); ++i) {
+                lines.append(Vertex({ (path[i - 1] % cols) * cellSize + half, (path[i - 1] / cols) * cellSize + half }, color));
+                lines.append(Vertex({ (path[i] % cols) * cellSize + half, (path[i] / cols) * cellSize + half }, color));
+            }
+        }
+        window.draw(lines);
+    }
+
+    void toggleFieldSource(int idx) {
+        auto it = find(fieldSources.begin(), fieldSources.end(), idx);
+        if (it != fieldSources.end()) fieldSources.erase(it);
+        else if (!grid[idx / cols][idx % cols].isWall) fieldSources.push_back(idx);
+        showField = true;
+        computeField();
+    }
+
+    void computeField() {
+        // Sources walled over since they were placed just drop out
+        vector<int> sources = fieldSources;
+        if (start)
+            sources.push_back(start->row * cols + start->col);
+        if (sources.empty()) {
+            showField = false;
+            statusText.setString("Set a start cell or Shift+click sources for the distance field");
+            return;
+        }
+        ScopedRun run("Bitset BFS");
+        auto t0 = chrono::steady_clock::now();
+        field.compute(WallMap(grid), sources);
+        perf.expansions += field.reached;
+        auto us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+        statusText.setString("Distance field: " + to_string(field.reached) + " cells, farthest " +
+            to_string(field.maxDistance) + " steps, " + to_string(us) + " us");
+    }
+
+    void clearSearch() {
+        search.cancel();
+        for (auto& row : grid) {
+            for (auto& cell : row) {
+                cell.isVisited = false;
+                cell.isPath = false;
+                cell.g = INFINITY;
+                cell.h = 0;
+                cell.parent = nullptr;
+            }
+        }
+        pathCells.clear();
+        visitedCells.clear();
+        pathFound = false;
+        scrubBar.clear();
+    }
+
+    // Expanded cells in search order, then the whole path as the last step
+    void recordSearch() {
+        scrubBar.begin(vector<int32_t>(rows * cols, 0));
+        RunHistory& history = scrubBar.history;
+        for (int idx : visitedCells) {
+            history.set(idx, 1);
+            history.endStep();
+        }
+        for (int idx : pathCells)
+            history.set(idx, 2);
+        if (!pathCells.empty())
+            history.endStep();
+    }
+
+    // Repairs the path after the wall at (row, col) flipped, touching only the
+    // cells LPA* re-expands; those are shown as visited for this edit.
+    void replan(int row, int col) {
+        if (!planner.isReady()) {
+            primePlanner();
+            return;
+        }
+        scrubBar.clear(); // the recorded search found the old path
+        for (int idx : visitedCells)
+            grid[idx / cols][idx % cols].isVisited = false;
+        for (int idx : pathCells)
+            grid[idx / cols][idx % cols].isPath = false;
+
+        ScopedRun run("LPA* repair");
+        auto t0 = chrono::steady_clock::now();
+        planner.cellChanged(row, col);
+        // Queued updates stay in the planner and are settled by a later edit
+        pathFound = components.connected(start, end) && planner.computeShortestPath();
+        pathCells = pathFound ? planner.path() : vector<int>();
+        if (!pathFound) planner.touched.clear();
+        perf.expansions += planner.touched.size();
+        auto us = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - t0).count();
+
+        visitedCells = planner.touched;
+        for (int idx : visitedCells)
+            grid[idx / cols][idx % cols].isVisited = true;
+        for (int idx : pathCells)
+            grid[idx / cols][idx % cols].isPath = true;
+
+        statusText.setString((pathFound ? "Replanned: " : "No path: ") + to_string(planner.touched.size()) +
+            " cells re-expanded in " + to_string(us) + " us");
+    }
+
+    // First edit after a search: a cold LPA* pass on a copy of the edited
+    // grid, in the background like the search itself. The result is picked
+    // up by update(); an edit meanwhile cancels it and primes again.
+    void primePlanner() {
+        clearSearch();
+        if (!components.connected(start, end)) {
+            statusText.setString("No path: start and end are in different regions");
+            return;
+        }
+        priming = true;
+        shownProgress = -1;
+        statusText.setString("Priming LPA*...");
+        vector<vector<Cell>> snapshot = grid;
+        int startIdx = start->row * cols + start->col;
+        int goalIdx = end->row * cols + end->col;
+        search.start([snapshot, startIdx, goalIdx](const CancelToken& token) mutable {
+            SearchResult result;
+            int cols = snapshot[0].size();
+            ScopedRun run("LPA* prime");
+            result.planner.reset(snapshot, &snapshot[startIdx / cols][startIdx % cols], &snapshot[goalIdx / cols][goalIdx % cols]);
+            result.found = result.planner.computeShortestPath(token);
+            perf.expansions += result.planner.touched.size();
+            if (token.isCancelled()) return result;
+            result.visitedCells = result.planner.touched;
+            vector<int> path = result.planner.path();
+            result.pathCells.assign(path.rbegin(), path.rend());
+            return result;
+        });
+    }
+
+public:
+    // Picks the instantiation for the view's movement and the grid's costs
+    static SearchResult searchGrid(vector<vector<Cell>>& cells, int startIdx, int goalIdx, Movement movement,
+        CostModel costs, ScratchArena& scratch, const CancelToken& token) {
+        bool unit = costs == CostModel::Unit;
+        switch (movement) {
+        case Movement::Four:
+            return unit ? searchGrid<Movement::Four, CostModel::Unit>(cells, startIdx, goalIdx, scratch, token)
+                : searchGrid<Movement::Four, CostModel::Terrain>(cells, startIdx, goalIdx, scratch, token);
+        case Movement::NoCornerCutting:
+            return unit ? searchGrid<Movement::NoCornerCutting, CostModel::Unit>(cells, startIdx, goalIdx, scratch, token)
+                : searchGrid<Movement::NoCornerCutting, CostModel::Terrain>(cells, startIdx, goalIdx, scratch, token);
+        default:
+            return unit ? searchGrid<Movement::CutCorners, CostModel::Unit>(cells, startIdx, goalIdx, scratch, token)
+                : searchGrid<Movement::CutCorners, CostModel::Terrain>(cells, startIdx, goalIdx, scratch, token);
+        }
+    }
+
+private:
+    // Plain A* over a private copy of the grid. Each movement and cost model
+    // is its own instantiation, so the 4-connected unit-cost search pays
+    // nothing for the others.
+    template <Movement M, CostModel C>
+    static SearchResult searchGrid(vector<vector<Cell>>& cells, int startIdx, int goalIdx, ScratchArena& scratch,
+        const CancelToken& token) {
+        // Without diagonals every step cost is an integer, so f values are too
+        using OpenList = conditional_t<M == Movement::Four, BucketQueue, HeapQueue>;
+
+        int cols = cells[0].size();
+        size_t total = cells.size() * cols;
+        Cell* start = &cells[startIdx / cols][startIdx % cols];
+        Cell* end = &cells[goalIdx / cols][goalIdx % cols];
+        SearchResult result;
+
+        ScopedRun run("A*");
+        OpenList openSet(scratch.reset());
+        result.visitedCells.reserve(total);
+        start->g = 0;
+        start->h = heuristic<M>(start, end);
+        openSet.push(start, start->h);
+        ++perf.heapPushes;
+
+        while (!openSet.empty()) {
+            Cell* current = openSet.pop();
+            // The heuristic is consistent, so a cell's first pop is final
+            if (current->isVisited) continue;
+
+            if (current == end) {
+                for (Cell* p = end; p; p = p->parent)
+                    result.pathCells.push_back(p->row * cols + p->col);
+                result.found = true;
+                result.cost = end->g;
+                break;
+            }
+
+            current->isVisited = true;
+            result.visitedCells.push_back(current->row * cols + current->col);
+            ++perf.expansions;
+            if (result.visitedCells.size() % 256 == 0) {
+                if (token.isCancelled()) return result;
+                token.report(static_cast<float>(result.visitedCells.size()) / total);
+            }
+
+            Cell* around[8];
+            int straight;
+            int aroundCount = neighbors<M>(cells, current, around, straight);
+            for (int i = 0; i < aroundCount; ++i) {
+                Cell* neighbor = around[i];
+                float step = M == Movement::Four || i < straight ? 1.f : diagonalCost;
+                if constexpr (C == CostModel::Terrain)
+                    step *= neighbor->cost;
+                float tentativeGScore = current->g + step;
+                ++perf.relaxations;
+                if (tentativeGScore < neighbor->g) {
+                    neighbor->parent = current;
+                    neighbor->g = tentativeGScore;
+                    neighbor->h = heuristic<M>(neighbor, end);
+                    openSet.push(neighbor, neighbor->g + neighbor->h);
+                    ++perf.heapPushes;
+                }
+            }
+        }
+        return result;
+    }
+
+    // Terrain costs are at least 1, so both stay admissible on painted grids
+    template <Movement M>
+    static float heuristic(Cell* a, Cell* b) {
+        int dr = abs(a->row - b->row), dc = abs(a->col - b->col);
+        if constexpr (M == Movement::Four)
+            return dr + dc; // Manhattan distance
+        else
+            return max(dr, dc) + (diagonalCost - 1) * min(dr, dc); // octile distance
+    }
+
+    // Fills out with the open cells around cell, straight steps first, and
+    // returns how many there are; straight gets the number of straight steps
+    template <Movement M>
+    static int neighbors(vector<vector<Cell>>& grid, Cell* cell, Cell* (&out)[8], int& straight) {
+        int rows = grid.size();
+        int cols = grid[0].size();
+        int count = 0;
+
+        int dr[] = { -1, 1, 0, 0 };
+        int dc[] = { 0, 0, -1, 1 };
+        bool open[4] = {};
+
+        for (int i = 0; i < 4; ++i) {
+            int nr = cell->row + dr[i];
+            int nc = cell->col + dc[i];
+            if (nr >= 0 && nr < rows && nc >= 0 && nc < cols && !grid[nr][nc].isWall) {
+                out[count++] = &grid[nr][nc];
+                open[i] = true;
+            }
+        }
+        straight = count;
+
+        if constexpr (M != Movement::Four) {
+            // Each diagonal passes between one vertical and one horizontal neighbour
+            for (int v = 0; v < 2; ++v) {
+                for (int h = 2; h < 4; ++h) {
+                    bool passable = M == Movement::CutCorners ? open[v] || open[h] : open[v] && open[h];
+                    int nr = cell->row + dr[v];
+                    int nc = cell->col + dc[h];
+                    if (passable && nr >= 0 && nr < rows && nc >= 0 && nc < cols && !grid[nr][nc].isWall)
+                        out[count++] = &grid[nr][nc];
+                }
+            }
+        }
+        return count;
+    }
+};
+
+// -- SCENARIO BENCHMARK --
+// Runs every scenario with each grid search the A* view offers and prints
+// solved count, mean expansions, mean path length over the optimum and the
+// time per query. Plain A* is exact on the 4-connected grid, so its lengths
+// are the optimum the others are measured against. The 8-connected row uses
+// the Moving AI movement rules and is measured against the .scen optima.
+void runScenarioBenchmark(const WallMap& map, const vector<Scenario>& scenarios, ostream& out) {
+    struct Row {
+        string mode;
+        int solved = 0;
+        double expansions = 0, ratio = 0, micros = 0;
+    };
+    auto print = [&](const Row& row) {
+        int n = max<size_t>(scenarios.size(), 1);
+        string solved = to_string(row.solved) + "/" + to_string(scenarios.size());
+        out << left << setw(22) << row.mode << right << setw(12) << solved
+            << fixed << setprecision(1) << setw(14) << row.expansions / n
+            << setprecision(4) << setw(12) << (row.solved ? row.ratio / row.solved : 0.0)
+            << setprecision(2) << setw(12) << row.micros / n << "\n";
+    };
+    auto elapsedMicros = [](chrono::steady_clock::time_point since) {
+        return chrono::duration<double, micro>(chrono::steady_clock::now() - since).count();
+    };
+
+    out << map.cols << "x" << map.rows << " map, " << scenarios.size() << " scenarios, 4-connected moves unless noted\n";
+    out << left << setw(22) << "mode" << right << setw(12) << "solved" << setw(14) << "expansions"
+        << setw(12) << "length/opt" << setw(12) << "us/query" << "\n";
+
+    vector<int> optimal(scenarios.size(), -1);
+    vector<int> path;
+    {
+        Row row{ "A*" };
+        GridSearchState state;
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            long long before = state.expansions;
+            auto t0 = chrono::steady_clock::now();
+            bool found = state.findPath(map, scenarios[i].start, scenarios[i].goal, path);
+            row.micros += elapsedMicros(t0);
+            row.expansions += state.expansions - before;
+            if (!found) continue;
+            optimal[i] = path.size() - 1;
+            ++row.solved;
+            row.ratio += 1;
+        }
+        print(row);
+    }
+
+    {
+        Row row{ "HPA*" };
+        vector<vector<Cell>> cells = cellsFromWalls(map);
+        HierarchicalPlanner hierarchy;
+        auto t0 = chrono::steady_clock::now();
+        hierarchy.build(cells);
+        double buildMs = elapsedMicros(t0) / 1000;
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            const Scenario& s = scenarios[i];
+            if (map.blocked[s.start] || map.blocked[s.goal]) continue;
+            t0 = chrono::steady_clock::now();
+            path = hierarchy.findPath(&cells[s.start / map.cols][s.start % map.cols], &cells[s.goal / map.cols][s.goal % map.cols]);
+            row.micros += elapsedMicros(t0);
+            row.expansions += hierarchy.abstractExpanded;
+            for (int work : hierarchy.clusterWork) row.expansions += work;
+            if (path.empty() || optimal[i] < 0) continue;
+            ++row.solved;
+            row.ratio += optimal[i] ? double(path.size() - 1) / optimal[i] : 1.0;
+        }
+        print(row);
+        out << "  (abstraction built once in " << fixed << setprecision(1) << buildMs << " ms, "
+            << hierarchy.entranceCount() << " entrances)\n";
+    }
+
+    {
+        vector<pair<int, int>> agents;
+        for (const Scenario& s : scenarios)
+            agents.push_back({ s.start, s.goal });
+        MultiAgentResult result = solveAgents(map, agents, thread::hardware_concurrency());
+        Row row{ "A* batch, " + to_string(result.threads) + (result.threads == 1 ? " thread" : " threads") };
+        row.expansions = result.expansions;
+        row.micros = result.seconds * 1e6;
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            if (result.paths[i].empty() || optimal[i] < 0) continue;
+            ++row.solved;
+            row.ratio += optimal[i] ? double(result.paths[i].size() - 1) / optimal[i] : 1.0;
+        }
+        print(row);
+    }
+
+    {
+        Row row{ "A* 8-connected" };
+        const vector<vector<Cell>> clean = cellsFromWalls(map);
+        ScratchArena scratch;
+        for (size_t i = 0; i < scenarios.size(); ++i) {
+            const Scenario& s = scenarios[i];
+            if (map.blocked[s.start] || map.blocked[s.goal]) continue;
+            vector<vector<Cell>> cells = clean; // searchGrid expects untouched cells
+            auto t0 = chrono::steady_clock::now();
+            AStarVisualizer::SearchResult search = AStarVisualizer::searchGrid(cells, s.start, s.goal,
+                Movement::NoCornerCutting, CostModel::Unit, scratch, CancelToken());
+            row.micros += elapsedMicros(t0);
+            row.expansions += search.visitedCells.size();
+            if (!search.found) continue;
+            ++row.solved;
+            row.ratio += s.optimal > 0 ? search.cost / s.optimal : 1.0;
+        }
+        print(row);
+    }
+
+    // The published optimum allows diagonal moves, so this shows what
+    // 4-connected movement costs on the map rather than a search error
+    double octile = 0;
+    int counted = 0;
+    for (size_t i = 0; i < scenarios.size(); ++i)
+        if (optimal[i] > 0 && scenarios[i].optimal > 0) {
+            octile += optimal[i] / scenarios[i].optimal;
+            ++counted;
+        }
+    if (counted)
+        out << "4-connected optimum / .scen octile optimum: " << fixed << setprecision(4) << octile / counted << "\n";
+}
+
+// -- FORD FULKERSON IMPLEMENTATION --
+class FordFulkersonVisualizer {
+    RectangleShape restartButton;
+    Text restartButtonText;
+
+private:
+    // Drawn through nodeBatch; a node's label is its index
+    struct Node {
+        Vector2f position;
+    };
+
+    vector<Node> nodes;
+    vector<Edge> edges;
+    Font font;
+    NodeBatch nodeBatch{ font, 14 }; // scratch, refilled when the layer is recorded
+    ForceLayout layout;
+
+    RectangleShape button;
+    Text buttonText;
+    Text instructionText;
+    Text maxFlowText;
+    Text inputPrompt;
+    Text inputText;
+    RectangleShape exitButton;
+    Text exitButtonText;
+
+    string userInput;
+
+    // Each augmenting path is pulled from the generator when the walker is
+    // ready for it; its flow is applied once the walker reaches the sink
+    struct Augmentation {
+        vector<int> path;      // nodes from source to sink
+        vector<int> pathEdges; // forward edge taken at each step
+        float flow = 0;
+    };
+    enum WalkPhase { Walking, NodePause, FlowPause };
+
+    Generator<Augmentation> flowSteps;
+    ScratchArena scratch; // residual graph and BFS buffers of the current run
+    Augmentation current;
+    bool animating = false;
+    size_t segment = 0;
+    WalkPhase phase = Walking;
+    AnimationClock phaseClock;
+    CircleShape walker;
+
+    float totalFlow = 0;
+    // One step per applied augmenting path: the flow of every edge, then the
+    // total, as float bits
+    ScrubBar scrubBar;
+    bool solved = false;      // the flow is maximal; edits resume the run
+    vector<bool> sourceSide;  // min cut of the last finished run, empty if stale
+    bool dirty = true;
+    StaticLayer staticLayer; // edges with flow/capacity labels and nodes
+
+public:
+    FordFulkersonVisualizer() {
+        font.loadFromFile("arial.ttf");
+
+        button.setSize(Vector2f(180, 35));
+        button.setFillColor(Color::Green);
+        button.setPosition(600, 35);
+
+        buttonText.setFont(font);
+        buttonText.setString("Find Max Flow");
+        buttonText.setCharacterSize(18);
+        buttonText.setFillColor(Color::White);
+        buttonText.setPosition(610, 40);
+
+        instructionText.setFont(font);
+        instructionText.setCharacterSize(20);
+        instructionText.setFillColor(Color::Yellow);
+        instructionText.setPosition(20, 10);
+        instructionText.setString("Click to add nodes. Type edges as: from to capacity.");
+
+        inputPrompt.setFont(font);
+        inputPrompt.setCharacterSize(20);
+        inputPrompt.setFillColor(Color::Yellow);
+        inputPrompt.setPosition(20, 520);
+        inputPrompt.setString("Edge Input (e.g. 0 1 10):");
+
+        inputText.setFont(font);
+        inputText.setCharacterSize(20);
+        inputText.setFillColor(Color::White);
+        inputText.setPosition(250, 520);
+
+        maxFlowText.setFont(font);
+        maxFlowText.setCharacterSize(20);
+        maxFlowText.setFillColor(Color::White);
+        maxFlowText.setPosition(20, 550);
+
+        exitButton.setSize({ 150, 35 });
+        exitButton.setFillColor(Color(150, 0, 0));
+        exitButton.setPosition(830,35);
+
+        exitButtonText.setFont(font);
+        exitButtonText.setCharacterSize(18);
+        exitButtonText.setFillColor(Color::White);
+        exitButtonText.setString("Exit");
+        exitButtonText.setPosition(850, 40);
+
+        walker.setRadius(8);
+        walker.setFillColor(Color::Cyan);
+        walker.setOrigin(8, 8);
+        //new constructor element is added
+        restartButton.setSize({ 150, 35 });
+        restartButton.setFillColor(Color::Blue);
+        restartButton.setPosition(420, 35);
+
+        restartButtonText.setFont(font);
+        restartButtonText.setCharacterSize(18);
+        restartButtonText.setFillColor(Color::White);
+        restartButtonText.setString("Restart");
+        restartButtonText.setPosition(480, 40);
+    }
+
+    //new code added
+
+    void reset() {
+        nodes.clear();
+        edges.clear();
+        userInput.clear();
+        animating = false;
+        totalFlow = 0;
+        solved = false;
+        sourceSide.clear();
+        flowSteps.reset();
+        maxFlowText.setString("");
+        scrubBar.clear();
+        dirty = true;
+        staticLayer.invalidate();
+        layout.clear();
+    }
+
+    void cancelRun() {
+        layout.stop();
+        if (!animating) return;
+        flowSteps.reset();
+        animating = false;
+        maxFlowText.setString("Max flow run cancelled");
+        dirty = true;
+    }
+
+    bool consumeDirty() {
+        bool wasDirty = dirty | scrubBar.consumeChanged();
+        dirty = false;
+        return wasDirty;
+    }
+
+    ScrubBar& scrubber() {
+        return scrubBar;
+    }
+
+    bool isAnimating() const {
+        return animating;
+    }
+
+    bool isBusy() const {
+        return animating || layout.isRunning();
+    }
+
+    void update() {
+        if (layout.isRunning()) {
+            layout.step();
+            const vector<Vector2f>& positions = layout.getPositions();
+            for (size_t i = 0; i < nodes.size(); i++)
+                nodes[i].position = positions[i];
+            staticLayer.invalidate();
+            dirty = true;
+        }
+        if (animating)
+            advanceWalker();
+    }
+
+    // F6: spreads the network out from where the nodes are now, or stops
+    void toggleLayout() {
+        dirty = true;
+        if (layout.isRunning()) {
+            layout.stop();
+            return;
+        }
+        if (animating) return;
+        vector<Vector2f> positions;
+        for (const Node& node : nodes)
+            positions.push_back(node.position);
+        vector<pair<int, int>> springs;
+        for (size_t i = 0; i < edges.size(); i += 2)
+            springs.push_back({ edges[i].from, edges[i].to });
+        layout.start(move(positions), move(springs), layoutArea());
+    }
+
+    // Right click: a pinned node keeps its place while the layout runs
+    void togglePin(Vector2f pos) {
+        int v = nodeAt(nodes, pos, 15);
+        if (v == -1) return;
+        layout.togglePin(v);
+        staticLayer.invalidate();
+        dirty = true;
+    }
+
+    bool isExitButtonClicked(Vector2f pos) {
+        return exitButton.getGlobalBounds().contains(pos);
+    }
+
+    void handleClick(Vector2f pos) {
+        dirty = true;
+        if (button.getGlobalBounds().contains(pos)) {
+            if (!animating)
+                startMaxFlow();
+            return;
+        }
+
+        if (isExitButtonClicked(pos)) {
+            return; // Exit will be handled by the main code
+        }
+
+        addNode(pos.x, pos.y);
+    }
+
+    void addNode(float x, float y) {
+        layout.stop(); // it only knows the nodes it started with
+        nodes.push_back({ {x, y} });
+        // The new node is the sink now, so the old flow ends in the wrong place
+        for (auto& edge : edges)
+            edge.flow = 0;
+        totalFlow = 0;
+        solved = false;
+        sourceSide.clear();
+        maxFlowText.setString("");
+        scrubBar.clear();
+        staticLayer.invalidate();
+    }
+
+    // Entering an edge that already exists sets its capacity instead (0 hides
+    // it). The current flow is kept: a raise only opens new augmenting paths,
+    // and a cut below the edge's flow is repaired around the edge.
+    void addEdge(int from, int to, float capacity) {
+        if (from < 0 || from >= nodes.size() || to < 0 || to >= nodes.size() || capacity < 0)
+            return;
+        staticLayer.invalidate();
+        sourceSide.clear();
+        scrubBar.clear(); // recorded on another network
+        size_t i = 0;
+        while (i < edges.size() && !(edges[i].from == from && edges[i].to == to))
+            i += 2;
+        if (i == edges.size()) {
+            layout.stop(); // it only knows the springs it started with
+            edges.push_back({ from, to, 0, capacity, 0 }); // weight=0 for FF
+            edges.push_back({ to, from, 0, 0, 0 });       // reverse edge with zero capacity
+            return;
+        }
+        edges[i].capacity = capacity;
+        if (edges[i].flow > capacity)
+            repairFlow(i);
+    }
+
+    void handleTextInput(Uint32 unicode) {
+        if (unicode == 8 && !userInput.empty()) {
+            userInput.pop_back();
+        }
+        else if (unicode >= 32 && unicode < 128) {
+            userInput += static_cast<char>(unicode);
+        }
+        inputText.setString(userInput);
+        dirty = true;
+    }
+
+    void processEdgeInput() {
+        dirty = true;
+        istringstream iss(userInput);
+        int from, to;
+        float cap;
+        if (iss >> from >> to >> cap) {
+            addEdge(from, to, cap);
+            if (solved)
+                startMaxFlow(); // keep the flow maximal through what-if edits
+        }
+        userInput.clear();
+        inputText.setString("");
+    }
+
+    // Augments from whatever flow the edges carry, which is always feasible:
+    // zero at first, then the result of earlier runs and repairs
+    void startMaxFlow() {
+        if (nodes.size() < 2) {
+            maxFlowText.setString("Add a source and a sink first");
+            return;
+        }
+        layout.stop(); // the walker follows fixed node positions
+        solved = false;
+        sourceSide.clear();
+        staticLayer.invalidate();
+        stringstream ss;
+        ss << "Max Flow so far: " << totalFlow;
+        maxFlowText.setString(ss.str());
+        flowSteps.reset(); // must let go of the arena before it is reset
+        flowSteps = augmentingPaths(nodes.size(), edges, scratch.reset());
+        vector<int32_t> flows;
+        for (const Edge& edge : edges)
+            flows.push_back(bit_cast<int32_t>(edge.flow));
+        flows.push_back(bit_cast<int32_t>(totalFlow));
+        scrubBar.begin(move(flows));
+        animating = true;
+        beginAugmentation();
+    }
+
+private:
+    // Edmonds-Karp on a private copy of the network, yielding one augmenting
+    // path at a time. Edges come in pairs, so the residual twin of edge i is
+    // i ^ 1 and no edge search is needed.
+    static Generator<Augmentation> augmentingPaths(int n, vector<Edge> network, pmr::memory_resource* scratch) {
+        ScopedRun run("Ford-Fulkerson");
+        int source = 0, sink = n - 1;
+        pmr::vector<pmr::vector<int>> outgoing(n, scratch);
+        for (size_t i = 0; i < network.size(); ++i)
+            outgoing[network[i].from].push_back(i);
+
+        pmr::vector<int> parentEdge(n, scratch);
+        pmr::vector<bool> visited(n, scratch);
+        pmr::vector<int> frontier(scratch); // BFS queue, consumed from head
+        frontier.reserve(n);
+        Augmentation step; // reused so each path fills the same buffers
+        while (true) {
+            TraceZone zone("BFS augmentation");
+            fill(visited.begin(), visited.end(), false);
+            frontier.clear();
+            frontier.push_back(source);
+            visited[source] = true;
+            for (size_t head = 0; head < frontier.size() && !visited[sink]; ++head) {
+                int u = frontier[head];
+                ++perf.expansions;
+                for (int i : outgoing[u]) {
+                    ++perf.relaxations;
+                    int v = network[i].to;
+                    if (!visited[v] && network[i].capacity - network[i].flow > 0) {
+                        visited[v] = true;
+                        parentEdge[v] = i;
+                        frontier.push_back(v);
+                    }
+                }
+            }
+            if (!visited[sink]) break;
+
+            step.path.clear();
+            step.pathEdges.clear();
+            step.flow = 1e9f;
+            for (int v = sink; v != source; v = network[parentEdge[v]].from) {
+                int i = parentEdge[v];
+                step.pathEdges.push_back(i);
+                step.flow = min(step.flow, network[i].capacity - network[i].flow);
+            }
+            reverse(step.pathEdges.begin(), step.pathEdges.end());
+            step.path.push_back(source);
+            for (int i : step.pathEdges) {
+                step.path.push_back(network[i].to);
+                network[i].flow += step.flow;
+                network[i ^ 1].flow -= step.flow;
+            }
+            ++perf.augmentingPaths;
+            zone.end();
+
+            run.pause();
+            co_yield step;
+            run.resume();
+        }
+    }
+
+    void beginAugmentation() {
+        dirty = true;
+        if (!flowSteps.next()) {
+            flowSteps.reset();
+            animating = false;
+            solved = true;
+            extractMinCut();
+            return;
+        }
+        current = flowSteps.value();
+        segment = 0;
+        phase = Walking;
+        walker.setPosition(nodes[current.path[0]].position);
+        phaseClock.restart();
+    }
+
+    // Walks the current path at 200 px/s, pausing 200 ms at each node and
+    // 500 ms after the path's flow has been applied
+    void advanceWalker() {
+        dirty = true;
+        float elapsed = phaseClock.getElapsedTime().asSeconds();
+
+        if (phase == Walking) {
+            Vector2f start = nodes[current.path[segment]].position;
+            Vector2f end = nodes[current.path[segment + 1]].position;
+            Vector2f dir = end - start;
+            float length = sqrt(dir.x * dir.x + dir.y * dir.y);
+            float moved = elapsed * 200.f;
+            if (moved < length) {
+                walker.setPosition(start + dir * (moved / length));
+                return;
+            }
+            walker.setPosition(end);
+            phase = NodePause;
+            phaseClock.restart();
+        }
+        else if (phase == NodePause && elapsed >= 0.2f) {
+            if (++segment + 1 < current.path.size()) {
+                phase = Walking;
+            }
+            else {
+                applyAugmentation(current);
+                phase = FlowPause;
+            }
+            phaseClock.restart();
+        }
+        else if (phase == FlowPause && elapsed >= 0.5f) {
+            beginAugmentation();
+        }
+    }
+
+    void applyAugmentation(const Augmentation& step) {
+        staticLayer.invalidate(); // flow labels changed
+        RunHistory& history = scrubBar.history;
+        for (int i : step.pathEdges) {
+            edges[i].flow += step.flow;
+            edges[i ^ 1].flow -= step.flow;
+            history.set(i, bit_cast<int32_t>(edges[i].flow));
+            history.set(i ^ 1, bit_cast<int32_t>(edges[i ^ 1].flow));
+        }
+        totalFlow += step.flow;
+        history.set(edges.size(), bit_cast<int32_t>(totalFlow));
+        history.endStep();
+        stringstream ss;
+        ss << "Max Flow so far: " << totalFlow;
+        maxFlowText.setString(ss.str());
+    }
+
+    vector<vector<int>> outgoingEdges() const {
+        vector<vector<int>> outgoing(nodes.size());
+        for (size_t i = 0; i < edges.size(); ++i)
+            outgoing[edges[i].from].push_back(i);
+        return outgoing;
+    }
+
+    // BFS over edges with spare capacity. Each reached node gets the edge it
+    // was reached by, the start gets -1 and unreached nodes -2.
+    vector<int> residualTree(int start, const vector<vector<int>>& outgoing) const {
+        vector<int> parentEdge(nodes.size(), -2);
+        vector<int> frontier{ start };
+        parentEdge[start] = -1;
+        for (size_t head = 0; head < frontier.size(); ++head) {
+            for (int i : outgoing[frontier[head]]) {
+                int v = edges[i].to;
+                if (parentEdge[v] == -2 && edges[i].capacity - edges[i].flow > 0) {
+                    parentEdge[v] = i;
+                    frontier.push_back(v);
+                }
+            }
+        }
+        return parentEdge;
+    }
+
+    // Sends up to limit units from one node to another along residual paths
+    // and returns how much got through
+    float pushResidual(int from, int to, float limit, const vector<vector<int>>& outgoing) {
+        float pushed = 0;
+        while (pushed < limit && from != to) {
+            vector<int> parentEdge = residualTree(from, outgoing);
+            if (parentEdge[to] == -2) break;
+            float amount = limit - pushed;
+            for (int v = to; v != from; v = edges[parentEdge[v]].from)
+                amount = min(amount, edges[parentEdge[v]].capacity - edges[parentEdge[v]].flow);
+            for (int v = to; v != from; v = edges[parentEdge[v]].from) {
+                edges[parentEdge[v]].flow += amount;
+                edges[parentEdge[v] ^ 1].flow -= amount;
+            }
+            pushed += amount;
+        }
+        return pushed;
+    }
+
+    // Edge i now carries more than its capacity. Trimming it leaves its tail
+    // with surplus and its head short by the same amount; the surplus is first
+    // rerouted to the head, and whatever is left is returned to the source and
+    // drawn back from the sink. Only paths through the edge are touched.
+    void repairFlow(int i) {
+        int source = 0, sink = nodes.size() - 1;
+        int tail = edges[i].from, head = edges[i].to;
+        float excess = edges[i].flow - edges[i].capacity;
+        edges[i].flow -= excess;
+        edges[i ^ 1].flow += excess;
+
+        vector<vector<int>> outgoing = outgoingEdges();
+        excess -= pushResidual(tail, head, excess, outgoing);
+        if (tail != source && tail != sink) {
+            float surplus = excess - pushResidual(tail, source, excess, outgoing);
+            pushResidual(tail, sink, surplus, outgoing);
+        }
+        if (head != source && head != sink) {
+            float shortfall = excess - pushResidual(sink, head, excess, outgoing);
+            pushResidual(source, head, shortfall, outgoing);
+        }
+
+        totalFlow = 0;
+        for (int e : outgoing[source])
+            totalFlow += edges[e].flow;
+        stringstream ss;
+        ss << "Flow after repair: " << totalFlow;
+        maxFlowText.setString(ss.str());
+    }
+
+    // The nodes still reachable from the source in the residual network form
+    // the source side of a minimum cut; the edges leaving it are saturated
+    void extractMinCut() {
+        vector<int> parentEdge = residualTree(0, outgoingEdges());
+        sourceSide.assign(nodes.size(), false);
+        for (size_t v = 0; v < nodes.size(); ++v)
+            sourceSide[v] = parentEdge[v] != -2;
+        int cutEdges = 0;
+        for (size_t i = 0; i < edges.size(); i += 2)
+            if (edges[i].capacity > 0 && sourceSide[edges[i].from] && !sourceSide[edges[i].to])
+                ++cutEdges;
+        staticLayer.invalidate();
+        stringstream ss;
+        ss << "Final Max Flow: " << totalFlow << "  (min cut: " << cutEdges << " red edges)";
+        maxFlowText.setString(ss.str());
+    }
+
+public:
+    bool isRestartButtonClicked(Vector2f pos) {
+        return restartButton.getGlobalBounds().contains(pos);
+    }
+
+    void draw(Canvas& window) {
+        // A scrubbed step is drawn directly; the layer keeps the live flow
+        bool scrubbing = scrubBar.isScrubbing();
+        if (scrubbing)
+            drawNetwork(window, &scrubBar.shown());
+        else
+            staticLayer.draw(window, [&](Canvas& layer) { drawNetwork(layer); });
+
+        window.draw(instructionText);
+        window.draw(button);
+        window.draw(buttonText);
+        if (scrubbing) {
+            stringstream ss;
+            ss << "Flow at this step: " << bit_cast<float>(scrubBar.shown()[edges.size()]);
+            Text recordedFlow = maxFlowText;
+            recordedFlow.setString(ss.str());
+            window.draw(recordedFlow);
+        }
+        else
+            window.draw(maxFlowText);
+        window.draw(inputPrompt);
+        window.draw(inputText);
+        window.draw(exitButton);
+        window.draw(exitButtonText);
+        //new code added here
+        window.draw(restartButton);
+        window.draw(restartButtonText);
+        scrubBar.draw(window);
+
+        if (animating && !scrubbing)
+            window.draw(walker);
+    }
+
+private:
+    // Flows come from the edges, or as float bits from a recorded step
+    void drawNetwork(Canvas& window, const vector<int32_t>* recorded = nullptr) {
+        for (size_t i = 0; i < edges.size(); i++) {
+            const Edge& edge = edges[i];
+            if (edge.capacity == 0) continue;
+            float flow = recorded ? bit_cast<float>((*recorded)[i]) : edge.flow;
+            bool cut = !recorded && !sourceSide.empty() && sourceSide[edge.from] && !sourceSide[edge.to];
+            Color lineColor = cut ? Color::Red : Color::White;
+            Vertex line[] = {
+                Vertex(nodes[edge.from].position, lineColor),
+                Vertex(nodes[edge.to].position, lineColor)
+            };
+            window.draw(line, 2, Lines);
+
+            // Draw flow/capacity
+            Text flowText;
+            flowText.setFont(font);
+            flowText.setCharacterSize(14);
+            flowText.setFillColor(Color::Yellow);
+            Vector2f mid = (nodes[edge.from].position + nodes[edge.to].position) / 2.f;
+            flowText.setPosition(mid);
+            flowText.setString(to_string(static_cast<int>(flow)) + "/" +
+                to_string(static_cast<int>(edge.capacity)));
+            window.draw(flowText);
+        }
+
+        nodeBatch.clear();
+        for (size_t i = 0; i < nodes.size(); i++) {
+            Vector2f pos = nodes[i].position;
+            Color fill = !recorded && !sourceSide.empty() && sourceSide[i] ? Color(0, 150, 0) : Color::Blue;
+            nodeBatch.addDisc(pos, 15, fill, layout.isPinned(i) ? Color::Red : Color::Transparent);
+            nodeBatch.addLabel(to_string(i), Vector2f(pos.x - 5, pos.y - 30), Color::White);
+        }
+        nodeBatch.draw(window);
+    }
+};
+
+
+//prims algorithm
+
+class PrimsVisualizer {
+private:
+    // Drawn through nodeBatch; a node's label is its index. Nodes in the tree
+    // pulse while the animation runs, each from the moment it joined.
+    enum NodeState : Uint8 { Idle, Selected, InTree };
+    struct Node {
+        Vector2f position;
+        float pulseStart = 0; // pulseClock seconds
+        NodeState state = Idle;
+    };
+    static constexpr float nodeRadius = 10.f;
+
+    struct Edge {
+        int from;
+        int to;
+        float weight;
+        bool isHighlighted = false;
+        Color color = Color::White;
+    };
+
+    struct AnimationStep {
+        int currentNode;
+        int addedNode;
+        int fromNode;
+        float weight;
+        bool isNodeSelection; // true for node selection, false for edge addition
+    };
+
+    vector<Node> nodes;
+    vector<Edge> edges;
+    vector<Text> edgeLabels;
+
+    Font font;
+    NodeBatch nodeBatch{ font, 14 }; // scratch, refilled for each draw
+    ForceLayout layout;
+    Text buttonText, mstWeightText, instructionText, inputPrompt, inputText, statusText;
+    RectangleShape button;
+    RectangleShape exitButton;
+    Text exitButtonText;
+    RectangleShape restartButton;
+    Text restartButtonText;
+    string userInput;
+    float totalMSTWeight = 0.0f;
+    bool showMST = false;
+
+    // Animation-related members
+    Generator<AnimationStep> primSteps; // pulled one step per animation tick
+    ScratchArena scratch; // connectivity check and Prim's queue and keys
+    AnimationClock animationClock;
+    bool isAnimating = false;
+    float animationSpeed = 2.0f; // seconds per step
+    vector<int> nodesInMST;
+    vector<Vertex> animatedMSTLines;
+    vector<int> mstLineEdges; // forward edge behind each line
+    // One step per animation step: each node's state, then per edge pair 0
+    // plain, 1 considered or 2 in the tree, then the tree weight as float bits
+    ScrubBar scrubBar;
+    int consideredSlot = -1;
+
+    // After a finished run the tree is kept minimal as edges are added: each
+    // node and each tree edge is a node of the forest, an edge's value being
+    // its weight, so the heaviest edge on the cycle a new edge closes is one
+    // path query away
+    bool maintainMST = false;
+    LinkCutForest forest;
+    vector<int> treeVertex;    // forest node of each graph node
+    vector<int> treeEdgeLine;  // line of each forest edge node, -1 for graph nodes
+    int treeCount = 0;         // trees in the spanning forest
+    int currentHighlightedEdge = -1;
+    int currentConsideredNode = -1;
+    bool dirty = true;
+    StaticLayer staticLayer; // edges in their highlight colors and edge labels
+
+public:
+    PrimsVisualizer() {
+        font.loadFromFile("arial.ttf");
+
+        button.setSize(Vector2f(200, 35));
+        button.setFillColor(Color(0, 100, 0));
+        button.setPosition(830, 20);
+
+        buttonText.setFont(font);
+        buttonText.setString("Run Prim's Algorithm");
+        buttonText.setCharacterSize(17);
+        buttonText.setFillColor(Color::White);
+        buttonText.setPosition(840, 28);
+
+        instructionText.setFont(font);
+        instructionText.setCharacterSize(20);
+        instructionText.setFillColor(Color::Yellow);
+        instructionText.setPosition(20, 10);
+        instructionText.setString("Click to add nodes. Type edges like: 0 1 10 and press Enter.");
+
+        inputPrompt.setFont(font);
+        inputPrompt.setCharacterSize(20);
+        inputPrompt.setFillColor(Color::Yellow);
+        inputPrompt.setPosition(20, 520);
+        inputPrompt.setString("Edge Input (format: from to weight):");
+
+        inputText.setFont(font);
+        inputText.setCharacterSize(20);
         inputText.setFillColor(Color::White);
         inputText.setPosition(350, 520);
 
-        mstWeightText.setFont(font);
-        mstWeightText.setCharacterSize(18);
-        mstWeightText.setFillColor(Color::Red);
-        mstWeightText.setPosition(20, 550);
+        mstWeightText.setFont(font);
+        mstWeightText.setCharacterSize(18);
+        mstWeightText.setFillColor(Color::Red);
+        mstWeightText.setPosition(20, 550);
+
+        statusText.setFont(font);
+        statusText.setCharacterSize(18);
+        statusText.setFillColor(Color::Yellow);
+        statusText.setPosition(20, 480);
+        statusText.setString("");
+
+        exitButton.setSize({ 100, 35 });
+        exitButton.setFillColor(Color::Red);
+        exitButton.setPosition(1050, 20);
+
+        exitButtonText.setFont(font);
+        exitButtonText.setCharacterSize(18);
+        exitButtonText.setFillColor(Color::White);
+        exitButtonText.setString("Exit");
+        exitButtonText.setPosition(1060, 25);
+
+        restartButton.setSize({ 100, 35 });
+        restartButton.setFillColor(Color::Blue);
+        restartButton.setPosition(700, 20);
+
+        restartButtonText.setFont(font);
+        restartButtonText.setCharacterSize(18);
+        restartButtonText.setFillColor(Color::White);
+        restartButtonText.setString("Restart");
+        restartButtonText.setPosition(730, 25);
+    }
+
+    void reset() {
+        nodes.clear();
+        edges.clear();
+        edgeLabels.clear();
+        animatedMSTLines.clear();
+        mstLineEdges.clear();
+        clearDynamicTree();
+        layout.clear();
+        primSteps.reset();
+        nodesInMST.clear();
+        totalMSTWeight = 0.0f;
+        showMST = false;
+        isAnimating = false;
+        userInput.clear();
+        inputText.setString("");
+        mstWeightText.setString("");
+        statusText.setString("");
+        currentHighlightedEdge = -1;
+        currentConsideredNode = -1;
+        scrubBar.clear();
+        dirty = true;
+        staticLayer.invalidate();
+    }
+
+    void cancelRun() {
+        layout.stop();
+        if (!isAnimating) return;
+        finishAnimation();
+        clearDynamicTree(); // a tree cut short is not minimal
+        statusText.setString("Prim's algorithm cancelled");
+    }
+
+    void addNode(float x, float y) {
+        layout.stop(); // it only knows the nodes it started with
+        Node node;
+        node.position = { x, y };
+        nodes.push_back(node);
+        scrubBar.clear(); // recorded on another graph
+        if (maintainMST) {
+            treeVertex.push_back(forest.add(-numeric_limits<float>::infinity()));
+            treeEdgeLine.resize(max<size_t>(treeEdgeLine.size(), treeVertex.back() + 1), -1);
+            ++treeCount;
+            showTreeWeight();
+        }
+    }
+
+    void addEdge(int from, int to, float weight) {
+        if (from >= 0 && to >= 0 && from < nodes.size() && to < nodes.size() && from != to) {
+            // Check if edge already exists
+            for (size_t i = 0; i < edges.size(); i++) {
+                if ((edges[i].from == from && edges[i].to == to) ||
+                    (edges[i].from == to && edges[i].to == from)) {
+                    statusText.setString("Edge already exists!");
+                    return;
+                }
+            }
+
+            // Add both directions for undirected graph
+            edges.push_back({ from, to, weight });
+            edges.push_back({ to, from, weight });
+
+            // Create edge label
+            Text label;
+            label.setFont(font);
+            label.setString(to_string(static_cast<int>(weight)));
+            label.setCharacterSize(14);
+            label.setFillColor(Color::Yellow);
+            placeEdgeLabel(label, from, to);
+
+            layout.stop(); // it only knows the springs it started with
+            edgeLabels.push_back(label);
+            staticLayer.invalidate();
+            scrubBar.clear();
+
+            statusText.setString("Added edge " + to_string(from) + " to " +
+                to_string(to) + " with weight " + to_string(static_cast<int>(weight)));
+            if (maintainMST)
+                insertIntoTree(edges.size() - 2);
+        }
+        else {
+            statusText.setString("Invalid edge: Check node indices or self-loops not allowed");
+        }
+    }
+
+private:
+    // Cycle property: the new edge belongs in the tree exactly when it is
+    // lighter than the heaviest tree edge between its endpoints
+    void insertIntoTree(int edge) {
+        int from = edges[edge].from, to = edges[edge].to;
+        float weight = edges[edge].weight;
+        string name = to_string(from) + "-" + to_string(to);
+        if (!forest.connected(treeVertex[from], treeVertex[to])) {
+            linkTreeEdge(edge, animatedMSTLines.size() / 2);
+            --treeCount;
+            statusText.setString("Edge " + name + " joins two trees of the MST");
+        }
+        else {
+            int heaviest = forest.heaviestOnPath(treeVertex[from], treeVertex[to]);
+            if (forest.value(heaviest) <= weight) {
+                statusText.setString("Edge " + name + " closes a cycle with no heavier edge, MST unchanged");
+                return;
+            }
+            int line = treeEdgeLine[heaviest];
+            int old = mstLineEdges[line];
+            string oldName = to_string(edges[old].from) + "-" + to_string(edges[old].to);
+            cutTreeEdge(heaviest);
+            linkTreeEdge(edge, line);
+            statusText.setString("Edge " + name + " replaces heavier edge " + oldName + " in the MST");
+        }
+        staticLayer.invalidate();
+        showTreeWeight();
+    }
+
+    // Puts the edge into the tree, drawn as the given line (one past the end
+    // for a new line)
+    void linkTreeEdge(int edge, size_t line) {
+        int from = edges[edge].from, to = edges[edge].to;
+        int x = forest.add(edges[edge].weight);
+        forest.link(x, treeVertex[from]);
+        forest.link(treeVertex[to], x);
+        treeEdgeLine.resize(max<size_t>(treeEdgeLine.size(), x + 1), -1);
+        treeEdgeLine[x] = line;
+
+        if (line == mstLineEdges.size()) {
+            mstLineEdges.push_back(edge);
+            animatedMSTLines.resize(animatedMSTLines.size() + 2);
+        }
+        mstLineEdges[line] = edge;
+        animatedMSTLines[2 * line] = Vertex(nodes[from].position, Color::Cyan);
+        animatedMSTLines[2 * line + 1] = Vertex(nodes[to].position, Color::Cyan);
+        for (int i : { edge, edge + 1 }) {
+            edges[i].isHighlighted = true;
+            edges[i].color = Color::Cyan;
+        }
+        totalMSTWeight += edges[edge].weight;
+    }
+
+    // Takes the edge behind forest node x out of the tree; its line is left
+    // for the caller to reuse
+    void cutTreeEdge(int x) {
+        int edge = mstLineEdges[treeEdgeLine[x]];
+        forest.cut(treeVertex[edges[edge].from], x);
+        forest.cut(x, treeVertex[edges[edge].to]);
+        forest.remove(x);
+        treeEdgeLine[x] = -1;
+        for (int i : { edge, edge + 1 }) {
+            edges[i].isHighlighted = false;
+            edges[i].color = Color::White;
+        }
+        totalMSTWeight -= edges[edge].weight;
+    }
+
+    // Rebuilds the forest from the tree a run just finished
+    void buildDynamicTree() {
+        forest.clear();
+        treeVertex.clear();
+        for (size_t v = 0; v < nodes.size(); v++)
+            treeVertex.push_back(forest.add(-numeric_limits<float>::infinity()));
+        treeEdgeLine.assign(nodes.size(), -1);
+        for (size_t line = 0; line < mstLineEdges.size(); line++) {
+            int edge = mstLineEdges[line];
+            int x = forest.add(edges[edge].weight);
+            forest.link(x, treeVertex[edges[edge].from]);
+            forest.link(treeVertex[edges[edge].to], x);
+            treeEdgeLine.push_back(line);
+        }
+        treeCount = nodes.size() - mstLineEdges.size();
+        maintainMST = true;
+    }
+
+    void clearDynamicTree() {
+        maintainMST = false;
+        forest.clear();
+        treeVertex.clear();
+        treeEdgeLine.clear();
+    }
+
+    void showTreeWeight() {
+        string text = "MST Weight: " + to_string(static_cast<int>(totalMSTWeight));
+        if (treeCount > 1)
+            text += "  (forest of " + to_string(treeCount) + " trees)";
+        mstWeightText.setString(text);
+        dirty = true;
+    }
+
+public:
+    // Midway along the edge, nudged to one side so it doesn't sit on the line
+    void placeEdgeLabel(Text& label, int from, int to) {
+        Vector2f midpoint = (nodes[from].position + nodes[to].position) / 2.f;
+        Vector2f offset = nodes[to].position - nodes[from].position;
+        float length = sqrt(offset.x * offset.x + offset.y * offset.y);
+        if (length > 0) {
+            offset = Vector2f(-offset.y, offset.x) * 8.f / length;
+            midpoint += offset;
+        }
+
+        // Center the text at the midpoint
+        FloatRect textBounds;
+        {
+            lock_guard<mutex> guard(glyphLock);
+            textBounds = label.getLocalBounds();
+        }
+        label.setPosition(
+            midpoint.x - textBounds.width / 2,
+            midpoint.y - textBounds.height / 2
+        );
+    }
+
+    void handleClick(Vector2f pos) {
+        dirty = true;
+        if (isAnimating) {
+            // Skip to next animation step if clicked during animation
+            nextAnimationStep();
+            return;
+        }
+
+        if (button.getGlobalBounds().contains(pos)) {
+            runPrimsAlgorithm();
+        }
+        else if (exitButton.getGlobalBounds().contains(pos)) {
+            // Will be handled in main
+        }
+        else if (restartButton.getGlobalBounds().contains(pos)) {
+            // Will be handled in main
+        }
+        else {
+            // Check if we're clicking on a node (select for edge creation)
+            bool nodeClicked = false;
+            for (size_t i = 0; i < nodes.size(); i++) {
+                Vector2f offset = pos - nodes[i].position;
+                if (abs(offset.x) <= nodeRadius + 1 && abs(offset.y) <= nodeRadius + 1) {
+                    // Handle node selection for edge creation
+                    if (currentConsideredNode == -1) {
+                        currentConsideredNode = i;
+                        nodes[i].state = Selected;
+                        statusText.setString("Node " + to_string(i) + " selected. Click another node to create edge.");
+                    }
+                    else if (currentConsideredNode != static_cast<int>(i)) {
+                        // Ask user for edge weight
+                        userInput = to_string(currentConsideredNode) + " " + to_string(i) + " ";
+                        inputText.setString(userInput);
+                        statusText.setString("Enter weight for edge " + to_string(currentConsideredNode) +
+                            " to " + to_string(i));
 
-        statusText.setFont(font);
-        statusText.setCharacterSize(18);
-        statusText.setFillColor(Color::Yellow);
-        statusText.setPosition(20, 480);
-        statusText.setString("");
+                        // Reset node colors
+                        nodes[currentConsideredNode].state = Idle;
+                        currentConsideredNode = -1;
+                    }
+                    nodeClicked = true;
+                    break;
+                }
+            }
+
+            // If no node was clicked, add a new node
+            if (!nodeClicked && currentConsideredNode == -1) {
+                addNode(pos.x, pos.y);
+            }
+            // If no node was clicked but one was selected, deselect it
+            else if (!nodeClicked && currentConsideredNode != -1) {
+                nodes[currentConsideredNode].state = Idle;
+                currentConsideredNode = -1;
+                statusText.setString("Node selection canceled");
+            }
+        }
+    }
+
+    void handleTextInput(Uint32 unicode) {
+        if (isAnimating) return; // Ignore input during animation
+        dirty = true;
+
+        if (unicode == 8 && !userInput.empty()) { // Backspace
+            userInput.pop_back();
+        }
+        else if (unicode == 13) { // Enter key
+            processEdgeInput();
+        }
+        else if (unicode >= 32 && unicode < 128) {
+            userInput += static_cast<char>(unicode);
+        }
+        inputText.setString(userInput);
+    }
+
+    void processEdgeInput() {
+        istringstream iss(userInput);
+        int from, to;
+        float weight;
+        if (iss >> from >> to >> weight) {
+            addEdge(from, to, weight);
+        }
+        else {
+            statusText.setString("Invalid input format. Use: from to weight");
+        }
+        userInput.clear();
+        inputText.setString("");
+    }
+
+    void runPrimsAlgorithm() {
+        int n = nodes.size();
+        if (n == 0) {
+            statusText.setString("Add nodes first before running the algorithm");
+            return;
+        }
+        if (n == 1) {
+            statusText.setString("Add more nodes to form a graph");
+            return;
+        }
+
+        primSteps.reset(); // must let go of the arena before it is reset
+        if (!isGraphConnected(n, edges, scratch.reset())) {
+            statusText.setString("Graph is not connected! Add more edges.");
+            return;
+        }
+        startAnimation();
+    }
+
+    // The heap version costs about E log V and the matrix scan V², so the
+    // scan wins once the graph is dense enough to pay for the matrix
+    static bool preferDense(size_t n, size_t edgeCount) {
+        return n > 1 && edgeCount * log2(double(n)) >= double(n) * n;
+    }
+
+    // Prim from node 0 on a copy of the graph, one animation step at a time
+    static Generator<AnimationStep> primAnimation(int n, vector<Edge> edges, pmr::memory_resource* scratch) {
+        ScopedRun run("Prim");
+        // Outgoing edges grouped by node, in edge list order
+        pmr::vector<int> firstEdge(n + 1, 0, scratch);
+        pmr::vector<int> byNode(edges.size(), scratch);
+        for (const Edge& edge : edges)
+            ++firstEdge[edge.from + 1];
+        for (int v = 0; v < n; ++v)
+            firstEdge[v + 1] += firstEdge[v];
+        pmr::vector<int> fill(firstEdge.begin(), firstEdge.end() - 1, scratch);
+        for (size_t i = 0; i < edges.size(); ++i)
+            byNode[fill[edges[i].from]++] = i;
+
+        pmr::vector<bool> inMST(n, false, scratch);
+        pmr::vector<float> key(n, numeric_limits<float>::max(), scratch);
+        pmr::vector<int> parent(n, -1, scratch);
+        key[0] = 0;
+
+        using P = pair<float, int>;
+        priority_queue<P, pmr::vector<P>, greater<P>> pq(greater<P>{}, pmr::vector<P>(scratch));
+        pq.push({ 0, 0 });
+        ++perf.heapPushes;
+
+        while (!pq.empty()) {
+            int u = pq.top().second;
+            pq.pop();
+
+            if (inMST[u]) continue;
+            inMST[u] = true;
+            ++perf.expansions;
+
+            // The first node is placed by startAnimation
+            if (u != 0) {
+                run.pause();
+                co_yield AnimationStep{ u, u, parent[u], key[u], true };
+                run.resume();
+            }
+
+            for (int e = firstEdge[u]; e < firstEdge[u + 1]; ++e) {
+                int i = byNode[e];
+                int v = edges[i].to;
+                float w = edges[i].weight;
+                ++perf.relaxations;
+                if (!inMST[v] && w < key[v]) {
+                    key[v] = w;
+                    parent[v] = u;
+                    pq.push({ key[v], v });
+                    ++perf.heapPushes;
+
+                    run.pause();
+                    co_yield AnimationStep{ u, v, u, w, false };
+                    run.resume();
+                }
+            }
+        }
+    }
+
+    // O(V²) Prim for dense graphs: the keys sit in one contiguous buffer that
+    // argmin scans, and each node joining the tree relaxes its row of the
+    // adjacency matrix. Tree nodes get an infinite key so the scan skips them.
+    static Generator<AnimationStep> densePrimAnimation(int n, vector<Edge> edges, pmr::memory_resource* scratch) {
+        ScopedRun run("Prim (dense)");
+        const float infinity = numeric_limits<float>::infinity();
+        pmr::vector<float> matrix(size_t(n) * n, infinity, scratch);
+        for (const Edge& edge : edges) {
+            float& cell = matrix[size_t(edge.from) * n + edge.to];
+            cell = min(cell, edge.weight);
+        }
+
+        pmr::vector<bool> inMST(n, false, scratch);
+        pmr::vector<float> key(n, infinity, scratch);
+        pmr::vector<int> parent(n, -1, scratch);
+        key[0] = 0;
+
+        for (int added = 0; added < n; ++added) {
+            int u = argmin(key.data(), n);
+            if (key[u] == infinity) break; // the rest is unreachable
+            float weight = key[u];
+            key[u] = infinity;
+            inMST[u] = true;
+            ++perf.expansions;
+
+            // The first node is placed by startAnimation
+            if (u != 0) {
+                run.pause();
+                co_yield AnimationStep{ u, u, parent[u], weight, true };
+                run.resume();
+            }
+
+            const float* row = &matrix[size_t(u) * n];
+            for (int v = 0; v < n; ++v) {
+                if (inMST[v] || row[v] == infinity) continue;
+                ++perf.relaxations;
+                if (row[v] < key[v]) {
+                    key[v] = row[v];
+                    parent[v] = u;
+
+                    run.pause();
+                    co_yield AnimationStep{ u, v, u, row[v], false };
+                    run.resume();
+                }
+            }
+        }
+    }
+
+    void startAnimation() {
+        // Reset previous animation state
+        primSteps.reset();
+        bool dense = preferDense(nodes.size(), edges.size());
+        if (dense)
+            primSteps = densePrimAnimation(nodes.size(), edges, scratch.reset());
+        else
+            primSteps = primAnimation(nodes.size(), edges, scratch.reset());
+        nodesInMST.clear();
+        animatedMSTLines.clear();
+        mstLineEdges.clear();
+        clearDynamicTree();
+        totalMSTWeight = 0.0f;
+
+        // Reset node colors
+        for (auto& node : nodes) {
+            node.state = Idle;
+        }
+
+        vector<int32_t> initial(nodes.size() + edges.size() / 2 + 1, 0);
+        if (!initial.empty()) initial[0] = InTree;
+        scrubBar.begin(move(initial));
+        consideredSlot = -1;
+
+        // Start animation
+        dirty = true;
+        isAnimating = true;
+        animationClock.restart();
+        statusText.setString(dense ? "Starting Prim's algorithm animation (dense scan)..." : "Starting Prim's algorithm animation...");
+        nodesInMST.push_back(0); // Add starting node
+
+        // Color the starting node
+        if (!nodes.empty()) {
+            nodes[0].state = InTree;
+            nodes[0].pulseStart = pulseClock.getElapsedTime().asSeconds();
+        }
+    }
+
+    // Edges are stored in both directions, so following them all from node 0
+    // reaches every node of a connected graph
+    static bool isGraphConnected(int n, const vector<Edge>& edges, pmr::memory_resource* scratch) {
+        TraceZone zone("Connectivity DFS");
+        pmr::vector<pmr::vector<int>> adjacencyList(n, scratch);
+        for (const Edge& edge : edges) {
+            adjacencyList[edge.from].push_back(edge.to);
+        }
+
+        pmr::vector<bool> visited(n, false, scratch);
+        pmr::vector<int> stack(scratch);
+        stack.push_back(0);
+        visited[0] = true;
+        while (!stack.empty()) {
+            int node = stack.back();
+            stack.pop_back();
+            for (int neighbor : adjacencyList[node]) {
+                if (!visited[neighbor]) {
+                    visited[neighbor] = true;
+                    stack.push_back(neighbor);
+                }
+            }
+        }
+
+        for (bool v : visited) {
+            if (!v) return false;
+        }
+        return true;
+    }
+
+    void nextAnimationStep() {
+        dirty = true;
+        if (!isAnimating || !primSteps.next()) {
+            // Animation complete
+            finishAnimation();
+            return;
+        }
+
+        AnimationStep step = primSteps.value();
+        staticLayer.invalidate(); // edge highlights change every step
+
+        // Reset highlighting from previous step
+        if (currentHighlightedEdge != -1) {
+            for (size_t i = 0; i < edges.size(); i++) {
+                edges[i].isHighlighted = false;
+                edges[i].color = Color::White;
+            }
+        }
+
+        if (step.isNodeSelection) {
+            // Adding a node to MST
+            if (step.addedNode < nodes.size()) {
+                nodes[step.addedNode].state = InTree;
+                nodes[step.addedNode].pulseStart = pulseClock.getElapsedTime().asSeconds();
+
+                // Add to MST nodes list
+                nodesInMST.push_back(step.addedNode);
+
+                // Add edge to MST if this isn't the first node
+                if (step.fromNode != -1) {
+                    Vertex line[] = {
+                        Vertex(nodes[step.fromNode].position, Color::Cyan),
+                        Vertex(nodes[step.addedNode].position, Color::Cyan)
+                    };
+                    animatedMSTLines.push_back(line[0]);
+                    animatedMSTLines.push_back(line[1]);
+
+                    totalMSTWeight += step.weight;
+                    mstWeightText.setString("MST Weight: " + to_string(static_cast<int>(totalMSTWeight)));
+
+                    // Highlight the edge in the original edge list
+                    for (size_t i = 0; i < edges.size(); i++) {
+                        if ((edges[i].from == step.fromNode && edges[i].to == step.addedNode) ||
+                            (edges[i].from == step.addedNode && edges[i].to == step.fromNode)) {
+                            edges[i].isHighlighted = true;
+                            edges[i].color = Color::Cyan;
+                        }
+                    }
+                    mstLineEdges.push_back(edgeBetween(step.fromNode, step.addedNode));
+                }
+                recordStep(step);
+
+                statusText.setString("Added node " + to_string(step.addedNode) + " to MST" +
+                    (step.fromNode != -1 ? " via edge from " + to_string(step.fromNode) : ""));
+            }
+        }
+        else {
+            // Considering an edge
+            currentHighlightedEdge = -1;
+            for (size_t i = 0; i < edges.size(); i++) {
+                if ((edges[i].from == step.fromNode && edges[i].to == step.addedNode) ||
+                    (edges[i].from == step.addedNode && edges[i].to == step.fromNode)) {
+                    edges[i].isHighlighted = true;
+                    edges[i].color = Color::Yellow; // Highlight in yellow for consideration
+                    currentHighlightedEdge = i;
+                }
+            }
+
+            statusText.setString("Considering edge from " + to_string(step.fromNode) +
+                " to " + to_string(step.addedNode) +
+                " with weight " + to_string(static_cast<int>(step.weight)));
+            recordStep(step);
+        }
+
+        animationClock.restart();
+    }
+
+    void recordStep(const AnimationStep& step) {
+        RunHistory& history = scrubBar.history;
+        int edgeSlots = nodes.size();
+        if (consideredSlot != -1 && history.current(consideredSlot) == 1)
+            history.set(consideredSlot, 0);
+        consideredSlot = -1;
+        if (step.isNodeSelection) {
+            history.set(step.addedNode, InTree);
+            if (step.fromNode != -1)
+                history.set(edgeSlots + mstLineEdges.back() / 2, 2);
+            history.set(edgeSlots + edges.size() / 2, bit_cast<int32_t>(totalMSTWeight));
+        }
+        else {
+            consideredSlot = edgeSlots + edgeBetween(step.fromNode, step.addedNode) / 2;
+            history.set(consideredSlot, 1);
+        }
+        history.endStep();
+    }
+
+    // Forward (even) index of the edge joining two nodes, -1 if there is none
+    int edgeBetween(int a, int b) const {
+        for (size_t i = 0; i < edges.size(); i += 2)
+            if ((edges[i].from == a && edges[i].to == b) || (edges[i].from == b && edges[i].to == a))
+                return i;
+        return -1;
+    }
+
+    void finishAnimation() {
+        primSteps.reset();
+        isAnimating = false;
+        showMST = true;
+        buildDynamicTree();
+
+        // Final status
+        statusText.setString("Prim's algorithm complete - MST weight: " +
+            to_string(static_cast<int>(totalMSTWeight)));
+    }
+
+    void update() {
+        if (isAnimating && animationClock.getElapsedTime().asSeconds() > animationSpeed) {
+            nextAnimationStep();
+        }
 
-        exitButton.setSize({ 100, 35 });
-        exitButton.setFillColor(Color::Red);
-        exitButton.setPosition(1050, 20);
+        // Tree nodes pulse for as long as the animation runs
+        if (isAnimating)
+            dirty = true;
 
-        exitButtonText.setFont(font);
-        exitButtonText.setCharacterSize(18);
-        exitButtonText.setFillColor(Color::White);
-        exitButtonText.setString("Exit");
-        exitButtonText.setPosition(1060, 25);
+        if (layout.isRunning()) {
+            layout.step();
+            moveNodes(layout.getPositions());
+        }
+    }
 
-        restartButton.setSize({ 100, 35 });
-        restartButton.setFillColor(Color::Blue);
-        restartButton.setPosition(700, 20);
+    // F6: spreads the graph out from where the nodes are now, or stops
+    void toggleLayout() {
+        dirty = true;
+        if (layout.isRunning()) {
+            layout.stop();
+            return;
+        }
+        if (isAnimating) return;
+        vector<Vector2f> positions;
+        for (const Node& node : nodes)
+            positions.push_back(node.position);
+        vector<pair<int, int>> springs;
+        for (size_t i = 0; i < edges.size(); i += 2)
+            springs.push_back({ edges[i].from, edges[i].to });
+        layout.start(move(positions), move(springs), layoutArea());
+    }
 
-        restartButtonText.setFont(font);
-        restartButtonText.setCharacterSize(18);
-        restartButtonText.setFillColor(Color::White);
-        restartButtonText.setString("Restart");
-        restartButtonText.setPosition(730, 25);
+    // Right click: a pinned node keeps its place while the layout runs
+    void togglePin(Vector2f pos) {
+        int v = nodeAt(nodes, pos, nodeRadius + 1);
+        if (v == -1) return;
+        layout.togglePin(v);
+        dirty = true;
     }
 
-    void reset() {
-        nodes.clear();
-        edges.clear();
-        edgeLabels.clear();
-        mstLines.clear();
-        animatedMSTLines.clear();
-        animationSteps.clear();
-        nodesInMST.clear();
-        totalMSTWeight = 0.0f;
-        showMST = false;
-        isAnimating = false;
-        userInput.clear();
-        inputText.setString("");
-        mstWeightText.setString("");
-        statusText.setString("");
-        currentHighlightedEdge = -1;
-        currentConsideredNode = -1;
+    // Takes positions from the layout and moves everything drawn from them
+    void moveNodes(const vector<Vector2f>& positions) {
+        for (size_t i = 0; i < nodes.size(); i++)
+            nodes[i].position = positions[i];
+        for (size_t i = 0; i < edgeLabels.size(); i++)
+            placeEdgeLabel(edgeLabels[i], edges[2 * i].from, edges[2 * i].to);
+        for (size_t i = 0; i < mstLineEdges.size(); i++) {
+            animatedMSTLines[2 * i].position = positions[edges[mstLineEdges[i]].from];
+            animatedMSTLines[2 * i + 1].position = positions[edges[mstLineEdges[i]].to];
+        }
+        staticLayer.invalidate();
+        dirty = true;
     }
 
-    void addNode(float x, float y) {
-        int id = nodes.size();
-        Node node;
-        node.position = { x, y };
-        node.shape.setRadius(10.f);
-        node.shape.setFillColor(Color::Blue);
-        node.shape.setPosition(x - 10.f, y - 10.f);
-        node.shape.setOutlineThickness(1.f);
-        node.shape.setOutlineColor(Color::White);
-
-        node.label.setFont(font);
-        node.label.setString(to_string(id));
-        node.label.setCharacterSize(14);
-        node.label.setFillColor(Color::White);
-
-        // Center the label properly
-        FloatRect textBounds = node.label.getLocalBounds();
-        node.label.setPosition(
-            x - textBounds.width / 2,
-            y - textBounds.height / 2 - 5.f
-        );
+    bool isExitButtonClicked(Vector2f pos) {
+        return exitButton.getGlobalBounds().contains(pos);
+    }
 
-        nodes.push_back(node);
+    bool isRestartButtonClicked(Vector2f pos) {
+        return restartButton.getGlobalBounds().contains(pos);
     }
 
-    void addEdge(int from, int to, float weight) {
-        if (from >= 0 && to >= 0 && from < nodes.size() && to < nodes.size() && from != to) {
-            // Check if edge already exists
-            for (size_t i = 0; i < edges.size(); i++) {
-                if ((edges[i].from == from && edges[i].to == to) ||
-                    (edges[i].from == to && edges[i].to == from)) {
-                    statusText.setString("Edge already exists!");
-                    return;
-                }
-            }
+    bool getIsAnimating() const {
+        return isAnimating;
+    }
 
-            // Add both directions for undirected graph
-            edges.push_back({ from, to, weight });
-            edges.push_back({ to, from, weight });
+    bool isBusy() const {
+        return isAnimating || layout.isRunning();
+    }
 
-            // Create edge label
-            Text label;
-            label.setFont(font);
-            label.setString(to_string(static_cast<int>(weight)));
-            label.setCharacterSize(14);
-            label.setFillColor(Color::Yellow);
+    bool consumeDirty() {
+        bool wasDirty = dirty | scrubBar.consumeChanged();
+        dirty = false;
+        return wasDirty;
+    }
 
-            // Position label midway between nodes with slight offset
-            Vector2f midpoint = (nodes[from].position + nodes[to].position) / 2.f;
-            // Add slight offset to make sure label doesn't overlap with edge
-            Vector2f offset = nodes[to].position - nodes[from].position;
-            float length = sqrt(offset.x * offset.x + offset.y * offset.y);
-            if (length > 0) {
-                offset = Vector2f(-offset.y, offset.x) * 8.f / length;
-                midpoint += offset;
+    ScrubBar& scrubber() {
+        return scrubBar;
+    }
+
+    void draw(Canvas& window) {
+        if (scrubBar.isScrubbing()) {
+            drawRecordedStep(window);
+            return;
+        }
+        staticLayer.draw(window, [&](Canvas& layer) {
+            // Draw edges
+            for (size_t i = 0; i < edges.size(); i += 2) {
+                Vertex line[] = {
+                    Vertex(nodes[edges[i].from].position, edges[i].isHighlighted ? edges[i].color : Color::White),
+                    Vertex(nodes[edges[i].to].position, edges[i].isHighlighted ? edges[i].color : Color::White)
+                };
+                layer.draw(line, 2, Lines);
             }
 
-            // Center the text at the midpoint
-            FloatRect textBounds = label.getLocalBounds();
-            label.setPosition(
-                midpoint.x - textBounds.width / 2,
-                midpoint.y - textBounds.height / 2
-            );
+            // Draw edge labels
+            for (size_t i = 0; i < edgeLabels.size(); i++) {
+                layer.draw(edgeLabels[i]);
+            }
+        });
 
-            edgeLabels.push_back(label);
+        drawControls(window);
+        window.draw(statusText);
 
-            statusText.setString("Added edge " + to_string(from) + " to " +
-                to_string(to) + " with weight " + to_string(static_cast<int>(weight)));
+        // Draw MST edges if algorithm has been run
+        if (!animatedMSTLines.empty()) {
+            window.draw(&animatedMSTLines[0], animatedMSTLines.size(), Lines);
+            window.draw(mstWeightText);
         }
-        else {
-            statusText.setString("Invalid edge: Check node indices or self-loops not allowed");
+
+        // Draw nodes
+        float now = pulseClock.getElapsedTime().asSeconds();
+        nodeBatch.clear();
+        for (size_t i = 0; i < nodes.size(); i++) {
+            const Node& node = nodes[i];
+            Color fill = node.state == InTree ? Color::Green : node.state == Selected ? Color::Yellow : Color::Blue;
+            float radius = nodeRadius;
+            if (isAnimating && node.state == InTree) {
+                float elapsed = fmod(now - node.pulseStart, 10.f); // restarts every 10 s
+                radius += 3.0f * sin(elapsed * 5.0f);
+            }
+            nodeBatch.addDisc(node.position, radius, fill, layout.isPinned(i) ? Color::Red : Color::White);
+            nodeBatch.addLabel(to_string(i), Vector2f(node.position.x, node.position.y - 5.f), Color::White, true);
         }
+        nodeBatch.draw(window);
+        scrubBar.draw(window);
     }
 
-    void handleClick(Vector2f pos) {
-        if (isAnimating) {
-            // Skip to next animation step if clicked during animation
-            nextAnimationStep();
-            return;
-        }
+private:
+    void drawControls(Canvas& window) {
+        window.draw(instructionText);
+        window.draw(button);
+        window.draw(buttonText);
+        window.draw(inputPrompt);
+        window.draw(inputText);
+        window.draw(exitButton);
+        window.draw(exitButtonText);
+        window.draw(restartButton);
+        window.draw(restartButtonText);
+    }
 
-        if (button.getGlobalBounds().contains(pos)) {
-            runPrimsAlgorithm();
-        }
-        else if (exitButton.getGlobalBounds().contains(pos)) {
-            // Will be handled in main
+    // The run as it stood at the scrubbed step, drawn from the recorded slots
+    void drawRecordedStep(Canvas& window) {
+        const vector<int32_t>& state = scrubBar.shown();
+        size_t n = nodes.size();
+        vector<Vertex> lines;
+        for (size_t i = 0; i < edges.size(); i += 2) {
+            int code = state[n + i / 2];
+            Color color = code == 2 ? Color::Cyan : code == 1 ? Color::Yellow : Color::White;
+            lines.push_back(Vertex(nodes[edges[i].from].position, color));
+            lines.push_back(Vertex(nodes[edges[i].to].position, color));
         }
-        else if (restartButton.getGlobalBounds().contains(pos)) {
-            // Will be handled in main
+        if (!lines.empty())
+            window.draw(&lines[0], lines.size(), Lines);
+        for (const Text& label : edgeLabels)
+            window.draw(label);
+
+        drawControls(window);
+        Text weight = mstWeightText;
+        weight.setString("MST Weight at this step: " + to_string(static_cast<int>(bit_cast<float>(state[n + edges.size() / 2]))));
+        window.draw(weight);
+
+        nodeBatch.clear();
+        for (size_t i = 0; i < n; i++) {
+            Color fill = state[i] == InTree ? Color::Green : Color::Blue;
+            nodeBatch.addDisc(nodes[i].position, nodeRadius, fill, layout.isPinned(i) ? Color::Red : Color::White);
+            nodeBatch.addLabel(to_string(i), Vector2f(nodes[i].position.x, nodes[i].position.y - 5.f), Color::White, true);
         }
-        else {
-            // Check if we're clicking on a node (select for edge creation)
-            bool nodeClicked = false;
-            for (size_t i = 0; i < nodes.size(); i++) {
-                if (nodes[i].shape.getGlobalBounds().contains(pos)) {
-                    // Handle node selection for edge creation
-                    if (currentConsideredNode == -1) {
-                        currentConsideredNode = i;
-                        nodes[i].shape.setFillColor(Color::Yellow);
-                        statusText.setString("Node " + to_string(i) + " selected. Click another node to create edge.");
-                    }
-                    else if (currentConsideredNode != static_cast<int>(i)) {
-                        // Ask user for edge weight
-                        userInput = to_string(currentConsideredNode) + " " + to_string(i) + " ";
-                        inputText.setString(userInput);
-                        statusText.setString("Enter weight for edge " + to_string(currentConsideredNode) +
-                            " to " + to_string(i));
+        nodeBatch.draw(window);
+        scrubBar.draw(window);
+    }
+};
 
-                        // Reset node colors
-                        nodes[currentConsideredNode].shape.setFillColor(Color::Blue);
-                        currentConsideredNode = -1;
-                    }
-                    nodeClicked = true;
-                    break;
-                }
+// -- ENGINE COMPARISON --
+// Two to four engines run on one input at the same time, each on a worker of
+// its own, and are then replayed side by side. The replay is synced either by
+// wall time, so each pane advances as fast as its engine really ran, or by
+// steps, so the panes show how much work each engine needed.
+
+// Seeded random graph for exports and comparisons: nodes scattered over the
+// layout area and sorted left to right, so node 0 and the last node sit at
+// opposite ends. Each node joins its nearest earlier node, which keeps the
+// graph connected, and its two nearest nodes overall.
+struct DemoGraph {
+    vector<Vector2f> positions;
+    vector<Edge> edges; // from < to
+};
+
+DemoGraph makeDemoGraph(int count, unsigned seed) {
+    DemoGraph graph;
+    mt19937 rng(seed);
+    FloatRect area = layoutArea();
+    uniform_real_distribution<float> x(area.left, area.left + area.width), y(area.top, area.top + area.height);
+    for (int i = 0; i < count; ++i)
+        graph.positions.push_back({ x(rng), y(rng) });
+    sort(graph.positions.begin(), graph.positions.end(), [](Vector2f a, Vector2f b) { return a.x < b.x; });
+
+    auto distance = [&](int a, int b) {
+        Vector2f d = graph.positions[a] - graph.positions[b];
+        return sqrt(d.x * d.x + d.y * d.y);
+    };
+    // Scans outwards from each node; with the nodes sorted by x a side is
+    // done once the x gap alone is no closer than what was already found
+    vector<pair<int, int>> pairs;
+    for (int i = 0; i < count; ++i) {
+        int nearest[2] = { -1, -1 }; // closest first
+        int earlier = -1;
+        auto closer = [&](int a, int b) { return b == -1 || distance(i, a) < distance(i, b); };
+        auto consider = [&](int j) {
+            if (closer(j, nearest[0])) {
+                nearest[1] = nearest[0];
+                nearest[0] = j;
             }
+            else if (closer(j, nearest[1]))
+                nearest[1] = j;
+        };
+        for (int j = i - 1; j >= 0; --j) {
+            float gap = graph.positions[i].x - graph.positions[j].x;
+            if ((nearest[1] != -1 && gap >= distance(i, nearest[1])) && (earlier != -1 && gap >= distance(i, earlier)))
+                break;
+            consider(j);
+            if (closer(j, earlier)) earlier = j;
+        }
+        for (int j = i + 1; j < count; ++j) {
+            if (nearest[1] != -1 && graph.positions[j].x - graph.positions[i].x >= distance(i, nearest[1])) break;
+            consider(j);
+        }
+        for (int j : nearest)
+            if (j != -1) pairs.push_back(minmax(i, j));
+        if (earlier != -1) pairs.push_back({ earlier, i });
+    }
+    sort(pairs.begin(), pairs.end());
+    pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+    for (auto [a, b] : pairs)
+        graph.edges.push_back({ a, b, max(1.f, roundf(distance(a, b) / 20)) });
+    return graph;
+}
 
-            // If no node was clicked, add a new node
-            if (!nodeClicked && currentConsideredNode == -1) {
-                addNode(pos.x, pos.y);
+enum class Engine { Dijkstra, Bidirectional, Landmarks, AStarBuckets, AStarHeap, LPAStar, BitsetBFS };
+
+const char* engineName(Engine engine) {
+    switch (engine) {
+    case Engine::Dijkstra: return "Dijkstra";
+    case Engine::Bidirectional: return "Bidirectional Dijkstra";
+    case Engine::Landmarks: return "ALT (landmarks)";
+    case Engine::AStarBuckets: return "A* (bucket queue)";
+    case Engine::AStarHeap: return "A* (binary heap)";
+    case Engine::LPAStar: return "LPA* (cold start)";
+    default: return "Bitset BFS";
+    }
+}
+
+// One input, read by every engine of a run at once
+struct ComparisonInput {
+    bool isGrid = false;
+    int source = 0, target = 0; // node or cell indices
+    // Graph: edges in twin pairs, as the Dijkstra view keeps them
+    vector<Vector2f> positions;
+    vector<Edge> edges;
+    vector<vector<int>> adjacency;
+    vector<vector<float>> landmarks; // built beforehand, outside any engine's time
+    // Grid: 4-connected with unit costs
+    WallMap map;
+};
+
+// An engine's run: the nodes it settled or the cells it expanded, in order.
+// A bidirectional search gives nodes settled from the target as -1 - u.
+struct EngineRun {
+    vector<int> order;
+    vector<int> path; // source first
+    float cost = 0;
+    bool found = false;
+    RunStats stats;
+};
+
+// Runs one engine to completion on the calling thread. Anything an engine
+// needs besides the input is set up before its ScopedRun starts, so the
+// stats only cover the search itself.
+EngineRun runEngine(const ComparisonInput& input, Engine engine, const CancelToken& token) {
+    EngineRun result;
+    int s = input.source, t = input.target;
+    if (!input.isGrid) {
+        ShortestPaths paths(input.edges, input.adjacency);
+        {
+            Generator<int> steps;
+            if (engine == Engine::Dijkstra) steps = paths.dijkstra(s);
+            else if (engine == Engine::Bidirectional) steps = paths.bidirectional(s, t);
+            else {
+                paths.useLandmarks(input.landmarks);
+                steps = paths.landmarks(s, t, input.positions);
             }
-            // If no node was clicked but one was selected, deselect it
-            else if (!nodeClicked && currentConsideredNode != -1) {
-                nodes[currentConsideredNode].shape.setFillColor(Color::Blue);
-                currentConsideredNode = -1;
-                statusText.setString("Node selection canceled");
+            result.order.reserve(input.adjacency.size());
+            while (steps.next()) {
+                result.order.push_back(steps.value());
+                // Only the query matters here, not the whole tree
+                if (engine == Engine::Dijkstra && steps.value() == t) break;
+                if (result.order.size() % 1024 == 0 && token.isCancelled()) return result;
             }
+        } // ending the generator ends its run
+        result.stats = lastRunOnThread;
+        if (engine == Engine::Dijkstra && paths.dist[t] != numeric_limits<float>::max()) {
+            for (int v = t; v != -1; v = paths.parent[v])
+                result.path.push_back(v);
+            reverse(result.path.begin(), result.path.end());
+        }
+        else if (engine != Engine::Dijkstra)
+            result.path = move(paths.path);
+        result.found = !result.path.empty();
+        for (size_t k = 1; k < result.path.size(); ++k) {
+            float w = numeric_limits<float>::max();
+            for (int i : input.adjacency[result.path[k - 1]])
+                if (input.edges[i].to == result.path[k]) w = min(w, input.edges[i].weight);
+            result.cost += w;
         }
+        return result;
     }
 
-    void handleTextInput(Uint32 unicode) {
-        if (isAnimating) return; // Ignore input during animation
-
-        if (unicode == 8 && !userInput.empty()) { // Backspace
-            userInput.pop_back();
+    const WallMap& map = input.map;
+    int n = map.rows * map.cols;
+    result.order.reserve(n);
+    switch (engine) {
+    case Engine::AStarBuckets: {
+        // The A* view's own search, on cells made from the map
+        vector<vector<Cell>> cells = cellsFromWalls(map);
+        ScratchArena scratch;
+        AStarVisualizer::SearchResult search = AStarVisualizer::searchGrid(cells, s, t, Movement::Four, CostModel::Unit,
+            scratch, token);
+        result.order = move(search.visitedCells);
+        result.path.assign(search.pathCells.rbegin(), search.pathCells.rend());
+        break;
+    }
+    case Engine::AStarHeap: {
+        GridSearchState state;
+        ScopedRun run("A* (binary heap)");
+        state.findPath(map, s, t, result.path, nullptr, &result.order);
+        perf.expansions = state.expansions;
+        break;
+    }
+    case Engine::LPAStar: {
+        vector<vector<Cell>> cells = cellsFromWalls(map);
+        LPAStarPlanner planner;
+        {
+            ScopedRun run("LPA*");
+            planner.reset(cells, &cells[s / map.cols][s % map.cols], &cells[t / map.cols][t % map.cols]);
+            planner.computeShortestPath(token);
+            perf.expansions = planner.touched.size();
         }
-        else if (unicode == 13) { // Enter key
-            processEdgeInput();
+        result.order = move(planner.touched);
+        result.path = planner.path();
+        break;
+    }
+    default: {
+        BitDistanceField field;
+        vector<int> sources = { s };
+        {
+            ScopedRun run("Bitset BFS");
+            field.compute(map, sources);
+            perf.expansions = field.reached;
         }
-        else if (unicode >= 32 && unicode < 128) {
-            userInput += static_cast<char>(unicode);
+        // Replayed level by level, the order the frontier grew in
+        vector<int> atLevel(field.maxDistance + 2, 0);
+        for (int d : field.distance)
+            if (d >= 0) ++atLevel[d + 1];
+        partial_sum(atLevel.begin(), atLevel.end(), atLevel.begin());
+        result.order.resize(field.reached);
+        for (int idx = 0; idx < n; ++idx)
+            if (field.distance[idx] >= 0) result.order[atLevel[field.distance[idx]]++] = idx;
+        if (field.distance[t] >= 0) {
+            // Walk back down the levels to the source
+            for (int idx = t; idx != s;) {
+                result.path.push_back(idx);
+                int r = idx / map.cols, c = idx % map.cols;
+                int around[4] = { r > 0 ? idx - map.cols : -1, r + 1 < map.rows ? idx + map.cols : -1,
+                                  c > 0 ? idx - 1 : -1, c + 1 < map.cols ? idx + 1 : -1 };
+                for (int v : around)
+                    if (v >= 0 && field.distance[v] == field.distance[idx] - 1) {
+                        idx = v;
+                        break;
+                    }
+            }
+            result.path.push_back(s);
+            reverse(result.path.begin(), result.path.end());
         }
-        inputText.setString(userInput);
+        break;
     }
+    }
+    result.stats = lastRunOnThread;
+    result.found = !result.path.empty();
+    result.cost = result.found ? result.path.size() - 1.f : 0;
+    return result;
+}
 
-    void processEdgeInput() {
-        istringstream iss(userInput);
-        int from, to;
-        float weight;
-        if (iss >> from >> to >> weight) {
-            addEdge(from, to, weight);
+class EngineComparison {
+    static const int maxPanes = 4;
+    static constexpr float replaySeconds = 8;
+
+    struct Pane {
+        Engine engine = Engine::Dijkstra;
+        BackgroundRun<EngineRun> job;
+        EngineRun run;
+        bool done = false;
+        // Per node, or per block of cells on a grid: the first step that
+        // reached it, and for nodes whether that was from the target side
+        vector<int> firstStep;
+        vector<uint8_t> fromTarget;
+        vector<uint8_t> onPath;
+        FloatRect area;  // whole pane
+        FloatRect board; // the graph or grid inside it
+        Text title;
+        Text counters;
+    };
+
+    const vector<Engine> graphEngines = { Engine::Dijkstra, Engine::Bidirectional, Engine::Landmarks };
+    const vector<Engine> gridEngines = { Engine::AStarBuckets, Engine::AStarHeap, Engine::LPAStar, Engine::BitsetBFS };
+    bool graphPicked[maxPanes] = { true, true, true, false };
+    bool gridPicked[maxPanes] = { true, true, true, true };
+    bool gridMode = false;
+
+    // Input
+    int graphNodes = 10000;
+    int gridCols = 240;
+    unsigned seed = 1;
+    WallMap importedMap;
+    vector<Scenario> scenarios; // longest first
+    size_t nextScenario = 0;
+    shared_ptr<const ComparisonInput> input;
+    double landmarkMs = 0;
+    string inputSummary;
+
+    // Runs and replay
+    array<Pane, maxPanes> panes; // fixed, the runs must not move
+    int paneCount = 0;
+    bool running = false;
+    Clock runClock;
+    int shownTenths = -1; // of a second, while the runs are going
+    bool replaying = false;
+    bool replayed = false;
+    AnimationClock replayClock;
+    bool syncBySteps = false;
+    double slowestMs = 0;
+    size_t mostSteps = 0;
+
+    // Grid panes draw blocks of block x block cells, so every quad is at
+    // least two pixels wide
+    int block = 1;
+    int blockRows = 0, blockCols = 0;
+    float blockPx = 1;
+    vector<uint8_t> blockWall;
+
+    StaticLayer staticLayer; // pane frames and the bare input in each pane
+    bool dirty = true;
+
+    Font font;
+    NodeBatch nodeBatch{ font, 12 }; // scratch, refilled for each draw
+    Text headerText;
+    Text helpText;
+    RectangleShape runButton, modeButton, restartButton, exitButton;
+    Text runButtonText, modeButtonText, restartButtonText, exitButtonText;
+
+public:
+    EngineComparison() {
+        font.loadFromFile("arial.ttf");
+        RectangleShape* buttons[] = { &runButton, &modeButton, &restartButton, &exitButton };
+        Text* labels[] = { &runButtonText, &modeButtonText, &restartButtonText, &exitButtonText };
+        const char* names[] = { "Run", "Graph / Grid", "Restart", "Exit" };
+        Color fills[] = { Color(0, 150, 0), Color(90, 90, 90), Color::Blue, Color::Red };
+        for (int i = 0; i < 4; ++i) {
+            buttons[i]->setSize({ 150, 35 });
+            buttons[i]->setFillColor(fills[i]);
+            buttons[i]->setPosition(40 + 170.f * i, 20);
+            labels[i]->setFont(font);
+            labels[i]->setCharacterSize(18);
+            labels[i]->setFillColor(Color::White);
+            labels[i]->setString(names[i]);
+            labels[i]->setPosition(55 + 170.f * i, 25);
         }
-        else {
-            statusText.setString("Invalid input format. Use: from to weight");
+
+        headerText.setFont(font);
+        headerText.setCharacterSize(18);
+        headerText.setFillColor(Color::White);
+        headerText.setPosition(40, 68);
+        helpText.setFont(font);
+        helpText.setCharacterSize(15);
+        helpText.setFillColor(Color(170, 170, 170));
+        helpText.setPosition(40, 95);
+        helpText.setString("Space: run   1-4: pick engines   Tab: graph / grid   Up/Down: input size   "
+            "R: new input   S: sync by wall time / steps");
+        for (Pane& pane : panes) {
+            pane.title.setFont(font);
+            pane.title.setCharacterSize(18);
+            pane.title.setFillColor(Color::White);
+            pane.counters.setFont(font);
+            pane.counters.setCharacterSize(14);
+            pane.counters.setFillColor(Color(200, 200, 200));
         }
-        userInput.clear();
-        inputText.setString("");
+        makeInput();
     }
 
-    void runPrimsAlgorithm() {
-        int n = nodes.size();
-        if (n == 0) {
-            statusText.setString("Add nodes first before running the algorithm");
-            return;
+    // Grid runs use the map instead of a random grid, starting with the
+    // scenario whose optimal path is longest
+    void loadMap(const WallMap& map, const vector<Scenario>& list) {
+        importedMap = map;
+        scenarios = list;
+        stable_sort(scenarios.begin(), scenarios.end(), [](const Scenario& a, const Scenario& b) {
+            return a.optimal > b.optimal;
+        });
+        nextScenario = 0;
+        if (gridMode) makeInput();
+    }
+
+    void run() {
+        cancelRun();
+        for (int k = 0; k < paneCount; ++k) {
+            Pane& pane = panes[k];
+            pane.run = EngineRun();
+            pane.done = false;
+            pane.job.start([shared = input, engine = pane.engine](const CancelToken& token) {
+                return runEngine(*shared, engine, token);
+            });
         }
-        if (n == 1) {
-            statusText.setString("Add more nodes to form a graph");
-            return;
+        running = true;
+        replaying = replayed = false;
+        shownTenths = -1;
+        runClock.restart();
+        dirty = true;
+    }
+
+    void cancelRun() {
+        if (!running) return;
+        for (Pane& pane : panes)
+            pane.job.cancel();
+        running = false;
+        headerText.setString(inputSummary + "   - run cancelled");
+        dirty = true;
+    }
+
+    // Restart: a fresh random input of the same size, or the next scenario
+    void reset() {
+        ++seed;
+        ++nextScenario;
+        makeInput();
+    }
+
+    void toggleMode() {
+        gridMode = !gridMode;
+        makeInput();
+    }
+
+    void resize(bool larger) {
+        if (gridMode && importedMap.rows > 0) return;
+        if (gridMode) gridCols = clamp(larger ? gridCols * 2 : gridCols / 2, 60, 960);
+        else graphNodes = clamp(larger ? graphNodes * 2 : graphNodes / 2, 1250, 20000);
+        makeInput();
+    }
+
+    // Keeps at least two engines picked
+    void toggleEngine(int i) {
+        bool* picked = gridMode ? gridPicked : graphPicked;
+        int available = gridMode ? gridEngines.size() : graphEngines.size();
+        if (i >= available) return;
+        if (picked[i] && count(picked, picked + available, true) <= 2) return;
+        picked[i] = !picked[i];
+        layoutPanes();
+    }
+
+    void toggleSync() {
+        syncBySteps = !syncBySteps;
+        dirty = true;
+    }
+
+    void handleKey(Keyboard::Key key) {
+        if (key == Keyboard::Space) run();
+        else if (key >= Keyboard::Num1 && key <= Keyboard::Num4) toggleEngine(key - Keyboard::Num1);
+        else if (key == Keyboard::Tab) toggleMode();
+        else if (key == Keyboard::Up || key == Keyboard::Down) resize(key == Keyboard::Up);
+        else if (key == Keyboard::R) reset();
+        else if (key == Keyboard::S) toggleSync();
+    }
+
+    void handleClick(Vector2f pos) {
+        if (runButton.getGlobalBounds().contains(pos)) run();
+        else if (modeButton.getGlobalBounds().contains(pos)) toggleMode();
+    }
+
+    bool isRestartButtonClicked(Vector2f pos) {
+        return restartButton.getGlobalBounds().contains(pos);
+    }
+
+    bool isExitButtonClicked(Vector2f pos) {
+        return exitButton.getGlobalBounds().contains(pos);
+    }
+
+    bool isBusy() const {
+        return running || replaying;
+    }
+
+    void update() {
+        if (running) {
+            bool all = true;
+            for (int k = 0; k < paneCount; ++k) {
+                Pane& pane = panes[k];
+                if (!pane.done && pane.job.poll(pane.run)) {
+                    pane.done = true;
+                    indexRun(pane);
+                }
+                all &= pane.done;
+            }
+            if (all) startReplay();
+            else if (int tenths = runClock.getElapsedTime().asMilliseconds() / 100; tenths != shownTenths) {
+                shownTenths = tenths;
+                dirty = true;
+            }
+        }
+        if (replaying) {
+            dirty = true;
+            if (replayClock.getElapsedTime().asSeconds() >= replaySeconds) {
+                replaying = false;
+                replayed = true;
+            }
+        }
+    }
+
+    bool consumeDirty() {
+        bool wasDirty = dirty;
+        dirty = false;
+        return wasDirty;
+    }
+
+    void draw(Canvas& window) {
+        staticLayer.draw(window, [&](Canvas& layer) {
+            for (int k = 0; k < paneCount; ++k)
+                drawBoard(layer, panes[k]);
+        });
+        for (int k = 0; k < paneCount; ++k) {
+            Pane& pane = panes[k];
+            size_t shown = shownSteps(pane);
+            if (input->isGrid) drawGridProgress(window, pane, shown);
+            else drawGraphProgress(window, pane, shown);
+            pane.counters.setString(describe(pane, shown));
+            window.draw(pane.title);
+            window.draw(pane.counters);
         }
+        window.draw(runButton);
+        window.draw(runButtonText);
+        window.draw(modeButton);
+        window.draw(modeButtonText);
+        window.draw(restartButton);
+        window.draw(restartButtonText);
+        window.draw(exitButton);
+        window.draw(exitButtonText);
+        window.draw(headerText);
+        window.draw(helpText);
+    }
 
-        // Check if graph is connected
-        vector<vector<int>> adjacencyList(n);
-        for (size_t i = 0; i < edges.size(); i += 2) {
-            adjacencyList[edges[i].from].push_back(edges[i].to);
+private:
+    void makeInput() {
+        TraceZone zone("Comparison input");
+        cancelRun();
+        shared_ptr<ComparisonInput> made = make_shared<ComparisonInput>();
+        stringstream ss;
+        if (!gridMode) {
+            DemoGraph demo = makeDemoGraph(graphNodes, seed);
+            made->positions = move(demo.positions);
+            made->adjacency.resize(graphNodes);
+            for (const Edge& e : demo.edges) {
+                made->adjacency[e.from].push_back(made->edges.size());
+                made->edges.push_back({ e.from, e.to, e.weight });
+                made->adjacency[e.to].push_back(made->edges.size());
+                made->edges.push_back({ e.to, e.from, e.weight });
+            }
+            made->target = graphNodes - 1;
+            ShortestPaths tables(made->edges, made->adjacency);
+            auto t0 = chrono::steady_clock::now();
+            tables.buildLandmarks(made->positions);
+            landmarkMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            made->landmarks = tables.landmarkTables();
+            ss << "Graph: " << graphNodes << " nodes, " << demo.edges.size() << " edges, node 0 to node "
+                << graphNodes - 1 << fixed << setprecision(1) << "   landmarks precomputed in " << landmarkMs
+                << " ms, not timed";
         }
-
-        vector<bool> visited(n, false);
-        function<void(int)> dfs = [&](int node) {
-            visited[node] = true;
-            for (int neighbor : adjacencyList[node]) {
-                if (!visited[neighbor]) {
-                    dfs(neighbor);
-                }
+        else if (importedMap.rows > 0) {
+            made->isGrid = true;
+            made->map = importedMap;
+            if (scenarios.empty()) {
+                ss << "Map: " << made->map.cols << "x" << made->map.rows << ", corner to corner";
+                made->target = made->map.rows * made->map.cols - 1;
             }
-            };
-
-        dfs(0);
-
-        bool isConnected = true;
-        for (bool v : visited) {
-            if (!v) {
-                isConnected = false;
-                break;
+            else {
+                nextScenario %= scenarios.size();
+                const Scenario& scenario = scenarios[nextScenario];
+                made->source = scenario.start;
+                made->target = scenario.goal;
+                ss << "Map: " << made->map.cols << "x" << made->map.rows << ", scenario " << nextScenario + 1 << "/"
+                    << scenarios.size() << " by length, octile optimum " << fixed << setprecision(1) << scenario.optimal;
             }
+            made->map.blocked[made->source] = made->map.blocked[made->target] = 0;
         }
-
-        if (!isConnected) {
-            statusText.setString("Graph is not connected! Add more edges.");
-            return;
+        else {
+            // Random walls until the corners are connected
+            made->isGrid = true;
+            WallMap& map = made->map;
+            map.cols = gridCols;
+            map.rows = gridCols * 7 / 12;
+            map.blocked.resize(map.rows * map.cols);
+            made->target = map.rows * map.cols - 1;
+            BitDistanceField reach;
+            for (unsigned attempt = 0; attempt < 20; ++attempt) {
+                mt19937 rng(seed * 31 + attempt);
+                for (auto& cell : map.blocked)
+                    cell = rng() % 100 < 25;
+                map.blocked.front() = map.blocked.back() = 0;
+                reach.compute(map, { 0 });
+                if (reach.distance[made->target] >= 0) break;
+            }
+            ss << "Grid: " << map.cols << "x" << map.rows << ", 25% walls, corner to corner";
         }
+        input = made;
+        inputSummary = ss.str();
+        headerText.setString(inputSummary);
+        layoutPanes();
+    }
 
-        // Reset previous animation state
-        animationSteps.clear();
-        nodesInMST.clear();
-        animatedMSTLines.clear();
-        currentAnimationStep = 0;
-        totalMSTWeight = 0.0f;
-
-        // Reset node colors
-        for (auto& node : nodes) {
-            node.shape.setFillColor(Color::Blue);
+    // Picked engines get the panes in order, two to a row
+    void layoutPanes() {
+        cancelRun();
+        headerText.setString(inputSummary);
+        const vector<Engine>& engines = gridMode ? gridEngines : graphEngines;
+        const bool* picked = gridMode ? gridPicked : graphPicked;
+        paneCount = 0;
+        for (size_t i = 0; i < engines.size(); ++i)
+            if (picked[i]) panes[paneCount++].engine = engines[i];
+
+        VideoMode desktop = VideoMode::getDesktopMode();
+        FloatRect area(40, 130, desktop.width - 80.f, desktop.height - 170.f);
+        int columns = min(paneCount, 2), rows = (paneCount + 1) / 2;
+        const float gap = 16, header = 60;
+        Vector2f size((area.width - gap * (columns - 1)) / columns, (area.height - gap * (rows - 1)) / rows);
+        for (int k = 0; k < paneCount; ++k) {
+            Pane& pane = panes[k];
+            pane.area = FloatRect(area.left + (k % 2) * (size.x + gap), area.top + (k / 2) * (size.y + gap), size.x, size.y);
+            pane.board = FloatRect(pane.area.left + 8, pane.area.top + header, pane.area.width - 16,
+                pane.area.height - header - 8);
+            pane.title.setString(engineName(pane.engine));
+            pane.title.setPosition(pane.area.left + 10, pane.area.top + 6);
+            pane.counters.setPosition(pane.area.left + 10, pane.area.top + 32);
+            pane.run = EngineRun();
+            pane.done = false;
+            pane.firstStep.clear();
+        }
+        replaying = replayed = false;
+
+        // Every board has the same size, so grid blocks are shared
+        if (input->isGrid) {
+            const WallMap& map = input->map;
+            float cellPx = min(panes[0].board.width / map.cols, panes[0].board.height / map.rows);
+            block = cellPx >= 2 ? 1 : static_cast<int>(ceil(2 / cellPx));
+            blockPx = block * cellPx;
+            blockRows = (map.rows + block - 1) / block;
+            blockCols = (map.cols + block - 1) / block;
+            vector<int> walls(blockRows * blockCols, 0), cells(blockRows * blockCols, 0);
+            for (int idx = 0; idx < map.rows * map.cols; ++idx) {
+                int b = blockOf(idx);
+                ++cells[b];
+                walls[b] += map.blocked[idx];
+            }
+            blockWall.resize(walls.size());
+            for (size_t b = 0; b < walls.size(); ++b)
+                blockWall[b] = walls[b] * 2 > cells[b];
         }
+        staticLayer.invalidate();
+        dirty = true;
+    }
 
-        vector<bool> inMST(n, false);
-        vector<float> key(n, numeric_limits<float>::max());
-        vector<int> parent(n, -1);
-        key[0] = 0;
+    int blockOf(int idx) const {
+        int cols = input->map.cols;
+        return (idx / cols / block) * blockCols + (idx % cols) / block;
+    }
 
-        using P = pair<float, int>;
-        priority_queue<P, vector<P>, greater<P>> pq;
-        pq.push({ 0, 0 });
+    // Graph positions come from the layout area; boards keep its aspect
+    Vector2f toBoard(const Pane& pane, Vector2f p) const {
+        FloatRect from = layoutArea();
+        float scale = min(pane.board.width / from.width, pane.board.height / from.height);
+        Vector2f offset((pane.board.width - from.width * scale) / 2, (pane.board.height - from.height * scale) / 2);
+        return Vector2f(pane.board.left, pane.board.top) + offset + (p - Vector2f(from.left, from.top)) * scale;
+    }
 
-        // First node is always in MST
-        animationSteps.push_back({ 0, 0, -1, 0, true });
+    float nodeRadius(const Pane& pane) const {
+        return clamp(sqrt(pane.board.width * pane.board.height / input->positions.size()) * 0.2f, 1.f, 4.f);
+    }
 
-        while (!pq.empty()) {
-            int u = pq.top().second;
-            pq.pop();
+    FloatRect blockRect(const Pane& pane, int b) const {
+        return FloatRect(pane.board.left + (b % blockCols) * blockPx, pane.board.top + (b / blockCols) * blockPx,
+            blockPx, blockPx);
+    }
 
-            if (inMST[u]) continue;
-            inMST[u] = true;
+    static void addQuad(vector<Vertex>& out, FloatRect box, Color color) {
+        out.push_back(Vertex({ box.left, box.top }, color));
+        out.push_back(Vertex({ box.left + box.width, box.top }, color));
+        out.push_back(Vertex({ box.left + box.width, box.top + box.height }, color));
+        out.push_back(Vertex({ box.left, box.top + box.height }, color));
+    }
 
-            // Add node selection to animation steps
-            if (u != 0) { // Skip first node which was already added
-                animationSteps.push_back({ u, u, parent[u], key[u], true });
-            }
+    // Finished runs are indexed once for drawing any step of the replay
+    void indexRun(Pane& pane) {
+        const EngineRun& run = pane.run;
+        int count = input->isGrid ? blockRows * blockCols : input->positions.size();
+        pane.firstStep.assign(count, INT_MAX);
+        pane.fromTarget.assign(count, 0);
+        pane.onPath.assign(count, 0);
+        for (size_t k = 0; k < run.order.size(); ++k) {
+            int v = run.order[k];
+            int at = input->isGrid ? blockOf(v) : v >= 0 ? v : -1 - v;
+            if (pane.firstStep[at] != INT_MAX) continue;
+            pane.firstStep[at] = k;
+            pane.fromTarget[at] = v < 0;
+        }
+        for (int v : run.path)
+            pane.onPath[input->isGrid ? blockOf(v) : v] = 1;
+    }
 
-            // Find all edges from u
-            for (size_t i = 0; i < edges.size(); i++) {
-                if (edges[i].from == u) {
-                    int v = edges[i].to;
-                    float w = edges[i].weight;
-                    if (!inMST[v] && w < key[v]) {
-                        key[v] = w;
-                        parent[v] = u;
-                        pq.push({ key[v], v });
-
-                        // Add edge consideration to animation steps
-                        animationSteps.push_back({ u, v, u, w, false });
-                    }
-                }
-            }
+    void startReplay() {
+        running = false;
+        slowestMs = 0;
+        mostSteps = 0;
+        float cost = -1;
+        bool agree = true;
+        for (int k = 0; k < paneCount; ++k) {
+            const EngineRun& run = panes[k].run;
+            slowestMs = max(slowestMs, run.stats.wallMs);
+            mostSteps = max(mostSteps, run.order.size());
+            if (k > 0 && (run.found != panes[0].run.found || abs(run.cost - cost) > 1e-3f * max(1.f, cost)))
+                agree = false;
+            cost = run.cost;
         }
+        stringstream ss;
+        ss << inputSummary << "   - ";
+        if (!agree) ss << "the engines disagree on the path!";
+        else if (!panes[0].run.found) ss << "no path";
+        else ss << "path cost " << fixed << setprecision(1) << cost;
+        if (workers.size() < (size_t)paneCount)
+            ss << "   (" << workers.size() << " workers for " << paneCount << " engines, some ran in turn)";
+        headerText.setString(ss.str());
+        replaying = true;
+        replayClock.restart();
+        dirty = true;
+    }
 
-        // Start animation
-        isAnimating = true;
-        animationClock.restart();
-        statusText.setString("Starting Prim's algorithm animation...");
-        nodesInMST.push_back(0); // Add starting node
+    // Replay position of a pane: on the wall clock every engine shares one
+    // time axis scaled to the slowest run, so the fastest finishes first
+    size_t shownSteps(const Pane& pane) const {
+        size_t total = pane.run.order.size();
+        if (!pane.done || running) return 0;
+        if (!replaying) return total;
+        float t = min(1.f, replayClock.getElapsedTime().asSeconds() / replaySeconds);
+        if (syncBySteps) return min(total, static_cast<size_t>(t * mostSteps));
+        if (pane.run.stats.wallMs <= 0) return total;
+        return min(total, static_cast<size_t>(total * t * slowestMs / pane.run.stats.wallMs));
+    }
 
-        // Color the starting node
-        if (!nodes.empty()) {
-            nodes[0].shape.setFillColor(Color::Green);
-            nodes[0].isPulsing = true;
-            nodes[0].pulseClock.restart();
+    string describe(const Pane& pane, size_t shown) const {
+        stringstream ss;
+        ss << fixed << setprecision(2);
+        if (running && !pane.done)
+            return "running... " + to_string(runClock.getElapsedTime().asMilliseconds()) + " ms";
+        if (running)
+            return "done, waiting for the others";
+        if (!pane.done)
+            return "press Space to run";
+        const EngineRun& run = pane.run;
+        double ms = run.order.empty() ? run.stats.wallMs : run.stats.wallMs * shown / run.order.size();
+        ss << (input->isGrid ? "expanded " : "settled ") << shown << " / " << run.order.size() << "   " << ms << " / "
+            << run.stats.wallMs << " ms";
+        if (shown == run.order.size()) {
+            if (run.stats.counters.relaxations > 0) ss << "   relaxed " << run.stats.counters.relaxations;
+            if (run.stats.counters.heapPushes > 0) ss << "   pushed " << run.stats.counters.heapPushes;
+            ss << setprecision(1) << (run.found ? "   cost " : "   no path");
+            if (run.found) ss << run.cost;
         }
+        return ss.str();
     }
 
-    void nextAnimationStep() {
-        if (!isAnimating || currentAnimationStep >= animationSteps.size()) {
-            // Animation complete
-            finishAnimation();
+    void drawBoard(Canvas& layer, const Pane& pane) {
+        RectangleShape frame({ pane.area.width, pane.area.height });
+        frame.setPosition(pane.area.left, pane.area.top);
+        frame.setFillColor(Color(20, 20, 20));
+        frame.setOutlineColor(Color(80, 80, 80));
+        frame.setOutlineThickness(1);
+        layer.draw(frame);
+
+        if (input->isGrid) {
+            vector<Vertex> quads;
+            for (size_t b = 0; b < blockWall.size(); ++b)
+                addQuad(quads, blockRect(pane, b), blockWall[b] ? Color(50, 50, 50) : Color(225, 225, 225));
+            layer.draw(quads.data(), quads.size(), Quads);
             return;
         }
+        vector<Vertex> lines;
+        for (size_t i = 0; i < input->edges.size(); i += 2) {
+            lines.push_back(Vertex(toBoard(pane, input->positions[input->edges[i].from]), Color(70, 70, 70)));
+            lines.push_back(Vertex(toBoard(pane, input->positions[input->edges[i].to]), Color(70, 70, 70)));
+        }
+        layer.draw(lines.data(), lines.size(), Lines);
+        nodeBatch.clear();
+        float r = nodeRadius(pane);
+        for (Vector2f p : input->positions)
+            nodeBatch.addDisc(toBoard(pane, p), r, Color(90, 90, 120));
+        nodeBatch.draw(layer);
+    }
 
-        AnimationStep& step = animationSteps[currentAnimationStep];
+    void drawGraphProgress(Canvas& window, const Pane& pane, size_t shown) {
+        float r = nodeRadius(pane);
+        nodeBatch.clear();
+        for (size_t k = 0; k < shown; ++k) {
+            int v = pane.run.order[k];
+            nodeBatch.addDisc(toBoard(pane, input->positions[v >= 0 ? v : -1 - v]), r,
+                v >= 0 ? Color(255, 140, 0) : Color(180, 80, 255));
+        }
+        if (shown > 0 && shown == pane.run.order.size() && pane.run.found) {
+            vector<Vertex> lines;
+            for (size_t k = 1; k < pane.run.path.size(); ++k) {
+                lines.push_back(Vertex(toBoard(pane, input->positions[pane.run.path[k - 1]]), Color::Cyan));
+                lines.push_back(Vertex(toBoard(pane, input->positions[pane.run.path[k]]), Color::Cyan));
+            }
+            window.draw(lines.data(), lines.size(), Lines);
+            for (int v : pane.run.path)
+                nodeBatch.addDisc(toBoard(pane, input->positions[v]), r, Color::Cyan);
+        }
+        nodeBatch.addDisc(toBoard(pane, input->positions[input->source]), r + 4, Color::Green);
+        nodeBatch.addDisc(toBoard(pane, input->positions[input->target]), r + 4, Color::Red);
+        nodeBatch.draw(window);
+    }
 
-        // Reset highlighting from previous step
-        if (currentHighlightedEdge != -1) {
-            for (size_t i = 0; i < edges.size(); i++) {
-                edges[i].isHighlighted = false;
-                edges[i].color = Color::White;
+    void drawGridProgress(Canvas& window, const Pane& pane, size_t shown) {
+        vector<Vertex> quads;
+        bool finished = shown > 0 && shown == pane.run.order.size();
+        if (shown > 0) {
+            for (size_t b = 0; b < pane.firstStep.size(); ++b) {
+                if (finished && pane.onPath[b]) addQuad(quads, blockRect(pane, b), Color::Yellow);
+                else if (pane.firstStep[b] < (int)shown) addQuad(quads, blockRect(pane, b), Color(100, 100, 255));
             }
         }
+        // Endpoints stay visible however small the blocks get
+        int ends[] = { input->source, input->target };
+        Color colors[] = { Color::Green, Color::Red };
+        for (int i = 0; i < 2; ++i) {
+            FloatRect box = blockRect(pane, blockOf(ends[i]));
+            float grow = max(0.f, 6 - box.width) / 2;
+            addQuad(quads, FloatRect(box.left - grow, box.top - grow, box.width + 2 * grow, box.height + 2 * grow), colors[i]);
+        }
+        window.draw(quads.data(), quads.size(), Quads);
+    }
+};
 
-        if (step.isNodeSelection) {
-            // Adding a node to MST
-            if (step.addedNode < nodes.size()) {
-                nodes[step.addedNode].shape.setFillColor(Color::Green);
-                nodes[step.addedNode].isPulsing = true;
-                nodes[step.addedNode].pulseClock.restart();
+// -- PERFORMANCE HUD --
+// Toggled with F3 in every view: frame time percentiles over the last few
+// seconds, draw calls, and the wall time and counters of the last run.
+class PerfHud {
+    static const size_t historySize = 240;
+    vector<float> frameMs;
+    size_t cursor = 0;
+    size_t drawCalls = 0;
+    bool visible = false;
 
-                // Add to MST nodes list
-                nodesInMST.push_back(step.addedNode);
+    Font font;
+    Text text;
+    RectangleShape panel;
 
-                // Add edge to MST if this isn't the first node
-                if (step.fromNode != -1) {
-                    Vertex line[] = {
-                        Vertex(nodes[step.fromNode].position, Color::Cyan),
-                        Vertex(nodes[step.addedNode].position, Color::Cyan)
-                    };
-                    animatedMSTLines.push_back(line[0]);
-                    animatedMSTLines.push_back(line[1]);
+public:
+    PerfHud() {
+        font.loadFromFile("arial.ttf");
+        text.setFont(font);
+        text.setCharacterSize(15);
+        text.setFillColor(Color::Green);
+        panel.setFillColor(Color(0, 0, 0, 180));
+        panel.setSize({ 330, 212 });
+    }
 
-                    totalMSTWeight += step.weight;
-                    mstWeightText.setString("MST Weight: " + to_string(static_cast<int>(totalMSTWeight)));
+    void toggle() {
+        visible = !visible;
+    }
 
-                    // Highlight the edge in the original edge list
-                    for (size_t i = 0; i < edges.size(); i++) {
-                        if ((edges[i].from == step.fromNode && edges[i].to == step.addedNode) ||
-                            (edges[i].from == step.addedNode && edges[i].to == step.fromNode)) {
-                            edges[i].isHighlighted = true;
-                            edges[i].color = Color::Cyan;
-                        }
-                    }
-                }
+    void recordFrame(float ms, size_t frameDrawCalls) {
+        if (frameMs.size() < historySize) frameMs.push_back(ms);
+        else frameMs[cursor] = ms;
+        cursor = (cursor + 1) % historySize;
+        drawCalls = frameDrawCalls;
+    }
 
-                statusText.setString("Added node " + to_string(step.addedNode) + " to MST" +
-                    (step.fromNode != -1 ? " via edge from " + to_string(step.fromNode) : ""));
-            }
+    void draw(Canvas& window) {
+        if (!visible) return;
+
+        vector<float> sorted = frameMs;
+        auto percentile = [&](float p) {
+            if (sorted.empty()) return 0.f;
+            size_t k = min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+            nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+            return sorted[k];
+        };
+
+        stringstream ss;
+        ss.setf(ios::fixed);
+        ss.precision(2);
+        ss << "Frame ms  p50 " << percentile(0.5f) << "  p95 " << percentile(0.95f)
+            << "  p99 " << percentile(0.99f) << "\n";
+        ss << "Draw calls: " << drawCalls << "\n";
+        RunStats run = latestRun();
+        if (run.algorithm.empty()) {
+            ss << "No algorithm run yet";
         }
         else {
-            // Considering an edge
-            currentHighlightedEdge = -1;
-            for (size_t i = 0; i < edges.size(); i++) {
-                if ((edges[i].from == step.fromNode && edges[i].to == step.addedNode) ||
-                    (edges[i].from == step.addedNode && edges[i].to == step.fromNode)) {
-                    edges[i].isHighlighted = true;
-                    edges[i].color = Color::Yellow; // Highlight in yellow for consideration
-                    currentHighlightedEdge = i;
-                }
-            }
-
-            statusText.setString("Considering edge from " + to_string(step.fromNode) +
-                " to " + to_string(step.addedNode) +
-                " with weight " + to_string(static_cast<int>(step.weight)));
+            ss << "Last run: " << run.algorithm << "  " << run.wallMs << " ms\n";
+            ss << "Heap pushes: " << run.counters.heapPushes << "\n";
+            ss << "Relaxations: " << run.counters.relaxations << "\n";
+            ss << "Expansions: " << run.counters.expansions << "\n";
+            ss << "Augmenting paths: " << run.counters.augmentingPaths << "\n";
+            ss << "Scratch allocs: " << run.counters.scratchAllocations
+                << "  from heap: " << run.counters.heapAllocations;
         }
+        text.setString(ss.str());
 
-        currentAnimationStep++;
-        animationClock.restart();
+        Vector2f corner(window.getSize().x - 350.f, 80.f);
+        panel.setPosition(corner);
+        text.setPosition(corner + Vector2f(10, 8));
+        window.draw(panel);
+        window.draw(text);
     }
+};
 
-    void finishAnimation() {
-        isAnimating = false;
-        showMST = true;
-        mstLines = animatedMSTLines;
+// -- FRAME EXPORT --
+// Headless recording. Each frame's scene is replayed into an off-screen
+// texture, read back, and handed to a pool of encoder threads. The frame loop
+// only queues work. It waits for an encoder only when the queued frames
+// would exceed maxQueuedBytes, so a long run on a slow disk cannot exhaust
+// memory. PNG frames are independent files. Y4M frames are converted to YUV
+// in parallel and appended to the one stream in frame order.
+class FrameExporter {
+public:
+    enum Format { PngSequence, Y4M };
 
-        // Final status
-        statusText.setString("Prim's algorithm complete - MST weight: " +
-            to_string(static_cast<int>(totalMSTWeight)));
+private:
+    // Converted frames wait here until every earlier one has been written
+    struct Stream {
+        ofstream out;
+        map<int, vector<Uint8>> ready;
+        int nextFrame = 0;
+        mutex lock;
+    };
 
-        // Stop all node pulsing
-        for (auto& node : nodes) {
-            node.isPulsing = false;
-            node.shape.setRadius(node.originalRadius);
+    static constexpr size_t maxQueuedBytes = size_t(1) << 30;
+
+    string path;
+    Format format = PngSequence;
+    size_t frameBytes = 0;
+    RenderTexture target;
+    SceneRenderer painter;
+    Stream stream;
+    int frames = 0;
+    int peakBacklog = 0;
+    int stalls = 0;
+    atomic<int> backlog{ 0 };
+    atomic<bool> failed{ false };
+    mutex backlogLock;
+    condition_variable encoded;
+    // Last, so its threads are joined before anything they use is destroyed
+    WorkerPool encoders{ max(2u, thread::hardware_concurrency()) - 1 };
+
+public:
+    ~FrameExporter() {
+        finish();
+    }
+
+    // Scenes laid out for logicalSize are scaled to size. path is a directory
+    // for PNG frames, or the .y4m file to write.
+    bool open(const string& outPath, Format outFormat, Vector2u size, Vector2u logicalSize, unsigned fps, string& error) {
+        path = outPath;
+        format = outFormat;
+        frameBytes = size_t(size.x) * size.y * 4;
+        if (!target.create(size.x, size.y)) {
+            error = "Cannot create a " + to_string(size.x) + "x" + to_string(size.y) + " off-screen texture";
+            return false;
+        }
+        target.setView(View(FloatRect(0, 0, logicalSize.x, logicalSize.y)));
+        // PNG frames go into path itself, a Y4M stream into its directory
+        filesystem::path directory = format == PngSequence ? filesystem::path(path) : filesystem::path(path).parent_path();
+        std::error_code code;
+        if (!directory.empty())
+            filesystem::create_directories(directory, code);
+        if (code) {
+            error = "Cannot create " + directory.string() + ": " + code.message();
+            return false;
         }
+        if (format == PngSequence)
+            return true;
+        stream.out.open(path, ios::binary);
+        if (!stream.out) {
+            error = "Cannot write " + path;
+            return false;
+        }
+        stream.out << "YUV4MPEG2 W" << size.x << " H" << size.y << " F" << fps << ":1 Ip A1:1 C420jpeg\n";
+        return true;
     }
 
-    void update() {
-        if (isAnimating && animationClock.getElapsedTime().asSeconds() > animationSpeed) {
-            nextAnimationStep();
+    void addFrame(const Scene& scene) {
+        TraceZone zone("Export frame");
+        target.clear(backgroundColor);
+        painter.draw(scene, target);
+        target.display();
+        auto image = make_shared<Image>(target.getTexture().copyToImage());
+        if ((backlog + 1) * frameBytes > maxQueuedBytes) {
+            ++stalls;
+            unique_lock<mutex> guard(backlogLock);
+            encoded.wait(guard, [this] { return (backlog + 1) * frameBytes <= maxQueuedBytes; });
         }
+        int index = frames++;
+        peakBacklog = max(peakBacklog, ++backlog);
+        encoders.submit([this, image, index] {
+            encode(*image, index);
+            lock_guard<mutex> guard(backlogLock);
+            --backlog;
+            encoded.notify_all();
+        });
+    }
 
-        // Update pulsing nodes
-        for (auto& node : nodes) {
-            if (node.isPulsing) {
-                float elapsed = node.pulseClock.getElapsedTime().asSeconds();
-                float pulseAmount = 3.0f * sin(elapsed * 5.0f);
-                node.pulseRadius = node.originalRadius + pulseAmount;
-                node.shape.setRadius(node.pulseRadius);
-                node.shape.setPosition(
-                    node.position.x - node.pulseRadius,
-                    node.position.y - node.pulseRadius
-                );
-
-                // Reset if pulse gets too large
-                if (elapsed > 10.0f) {
-                    node.pulseClock.restart();
-                }
-            }
+    // Waits for the encoders; false if any frame failed to write
+    bool finish() {
+        unique_lock<mutex> guard(backlogLock);
+        encoded.wait(guard, [this] { return backlog.load() == 0; });
+        if (stream.out.is_open()) {
+            stream.out.close();
+            if (stream.out.fail()) failed = true;
         }
+        painter.clear();
+        return !failed;
     }
 
-    bool isExitButtonClicked(Vector2f pos) {
-        return exitButton.getGlobalBounds().contains(pos);
+    int frameCount() const {
+        return frames;
     }
 
-    bool isRestartButtonClicked(Vector2f pos) {
-        return restartButton.getGlobalBounds().contains(pos);
+    int peakFramesQueued() const {
+        return peakBacklog;
     }
 
-    bool getIsAnimating() const {
-        return isAnimating;
+    // Frames that had to wait for room in the queue
+    int stalledFrames() const {
+        return stalls;
     }
 
-    void draw(RenderWindow& window) {
-        window.draw(instructionText);
-        window.draw(button);
-        window.draw(buttonText);
-        window.draw(inputPrompt);
-        window.draw(inputText);
-        window.draw(exitButton);
-        window.draw(exitButtonText);
-        window.draw(restartButton);
-        window.draw(restartButtonText);
-        window.draw(statusText);
+private:
+    void encode(const Image& image, int index) {
+        TraceZone zone("Export encode");
+        if (format == PngSequence) {
+            char name[32];
+            snprintf(name, sizeof(name), "frame_%06d.png", index);
+            if (!image.saveToFile((filesystem::path(path) / name).string()))
+                failed = true;
+            return;
+        }
 
-        // Draw edges
-        for (size_t i = 0; i < edges.size(); i += 2) {
-            Vertex line[] = {
-                Vertex(nodes[edges[i].from].position, edges[i].isHighlighted ? edges[i].color : Color::White),
-                Vertex(nodes[edges[i].to].position, edges[i].isHighlighted ? edges[i].color : Color::White)
-            };
-            window.draw(line, 2, Lines);
+        vector<Uint8> yuv = toYuv420(image);
+        lock_guard<mutex> guard(stream.lock);
+        stream.ready.emplace(index, move(yuv));
+        while (!stream.ready.empty() && stream.ready.begin()->first == stream.nextFrame) {
+            auto first = stream.ready.begin();
+            stream.out << "FRAME\n";
+            stream.out.write(reinterpret_cast<const char*>(first->second.data()), first->second.size());
+            stream.ready.erase(first);
+            ++stream.nextFrame;
         }
+    }
 
-        // Draw edge labels
-        for (size_t i = 0; i < edgeLabels.size(); i++) {
-            window.draw(edgeLabels[i]);
+    // Full-range BT.601, chroma averaged over each 2x2 block
+    static vector<Uint8> toYuv420(const Image& image) {
+        Vector2u size = image.getSize();
+        unsigned w = size.x, h = size.y, cw = (w + 1) / 2, ch = (h + 1) / 2;
+        const Uint8* rgba = image.getPixelsPtr();
+        vector<Uint8> out(w * h + 2 * cw * ch);
+        Uint8* y = out.data();
+        Uint8* u = y + w * h;
+        Uint8* v = u + cw * ch;
+        for (unsigned i = 0; i < w * h; ++i) {
+            const Uint8* p = rgba + 4 * i;
+            y[i] = static_cast<Uint8>(0.299f * p[0] + 0.587f * p[1] + 0.114f * p[2] + 0.5f);
+        }
+        for (unsigned cy = 0; cy < ch; ++cy) {
+            for (unsigned cx = 0; cx < cw; ++cx) {
+                float r = 0, g = 0, b = 0;
+                int count = 0;
+                for (unsigned py = 2 * cy; py < min(h, 2 * cy + 2); ++py)
+                    for (unsigned px = 2 * cx; px < min(w, 2 * cx + 2); ++px) {
+                        const Uint8* p = rgba + 4 * (py * w + px);
+                        r += p[0];
+                        g += p[1];
+                        b += p[2];
+                        ++count;
+                    }
+                r /= count;
+                g /= count;
+                b /= count;
+                u[cy * cw + cx] = static_cast<Uint8>(128 - 0.168736f * r - 0.331264f * g + 0.5f * b + 0.5f);
+                v[cy * cw + cx] = static_cast<Uint8>(128 + 0.5f * r - 0.418688f * g - 0.081312f * b + 0.5f);
+            }
         }
+        return out;
+    }
+};
 
-        // Draw MST edges if algorithm has been run
-        if (!animatedMSTLines.empty()) {
-            window.draw(&animatedMSTLines[0], animatedMSTLines.size(), Lines);
-            window.draw(mstWeightText);
+// Plays a view's run on the fixed timeline, one frame per period, until the
+// view has been idle for a second or maxSeconds of video are recorded
+template <typename Visualizer>
+void recordRun(Visualizer& view, FrameExporter& exporter, Vector2u logicalSize, unsigned fps, float maxSeconds) {
+    Scene scene;
+    scene.size = logicalSize;
+    Time period = seconds(1.f / fps);
+    int idleFrames = 0;
+    for (int frame = 0; frame < maxSeconds * fps && idleFrames < (int)fps; ++frame) {
+        view.update();
+        scene.clear();
+        Canvas canvas(scene);
+        view.draw(canvas);
+        exporter.addFrame(scene);
+        timeline.advance(period);
+        idleFrames = view.isBusy() ? 0 : idleFrames + 1;
+    }
+}
+
+// --export: builds a demo input for the view, starts its algorithm, and
+// records the run at a fixed timestep with --steps algorithm steps per frame.
+// The graph views get a seeded random graph; the A* view gets the imported
+// map and its first scenario, or a random grid from corner to corner.
+int runExport(const string& view, const string& path, unsigned fps, Vector2u size, unsigned nodeCount, unsigned seed,
+    const WallMap& importedMap, vector<Scenario> scenarios) {
+    if (path.empty()) {
+        cerr << "--export needs --out" << endl;
+        return 1;
+    }
+    // The views lay themselves out for the desktop; frames are scaled from it
+    VideoMode desktop = VideoMode::getDesktopMode();
+    Vector2u logicalSize(desktop.width, desktop.height);
+    if (size.x == 0 || size.y == 0)
+        size = logicalSize;
+    bool y4m = filesystem::path(path).extension() == ".y4m";
+    if (y4m && (size.x % 2 || size.y % 2)) {
+        cerr << "Y4M frames need an even width and height" << endl;
+        return 1;
+    }
+
+    FrameExporter exporter;
+    string error;
+    if (!exporter.open(path, y4m ? FrameExporter::Y4M : FrameExporter::PngSequence, size, logicalSize, fps, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    timeline.useFixedStep();
+    const float maxSeconds = 600;
+    auto t0 = chrono::steady_clock::now();
+
+    DemoGraph demo = makeDemoGraph(nodeCount, seed);
+    if (view == "dijkstra") {
+        Graph graph;
+        for (Vector2f p : demo.positions)
+            graph.addNode(p);
+        for (const Edge& e : demo.edges)
+            graph.addEdgeFromText(to_string(e.from) + " " + to_string(e.to) + " " + to_string(static_cast<int>(e.weight)));
+        graph.findShortestPath(0, nodeCount - 1);
+        recordRun(graph, exporter, logicalSize, fps, maxSeconds);
+    }
+    else if (view == "flow") {
+        FordFulkersonVisualizer flow;
+        for (Vector2f p : demo.positions)
+            flow.addNode(p.x, p.y);
+        for (const Edge& e : demo.edges)
+            flow.addEdge(e.from, e.to, e.weight);
+        flow.startMaxFlow();
+        recordRun(flow, exporter, logicalSize, fps, maxSeconds);
+    }
+    else if (view == "prim") {
+        PrimsVisualizer prim;
+        for (Vector2f p : demo.positions)
+            prim.addNode(p.x, p.y);
+        for (const Edge& e : demo.edges)
+            prim.addEdge(e.from, e.to, e.weight);
+        prim.startAnimation();
+        recordRun(prim, exporter, logicalSize, fps, maxSeconds);
+    }
+    else if (view == "astar") {
+        WallMap map = importedMap;
+        if (map.rows == 0) {
+            map.rows = 50;
+            map.cols = 80;
+            map.blocked.resize(map.rows * map.cols);
+            mt19937 rng(seed);
+            for (auto& cell : map.blocked)
+                cell = rng() % 100 < 25;
+            map.blocked.front() = map.blocked.back() = 0;
         }
+        if (scenarios.empty())
+            scenarios.push_back({ 0, map.rows * map.cols - 1, 0 });
+        AStarVisualizer astar;
+        astar.loadMap(map);
+        astar.loadScenarios({ scenarios.front() });
+        astar.showNextScenario();
+        astar.runAStar();
+        recordRun(astar, exporter, logicalSize, fps, maxSeconds);
+    }
+    else {
+        cerr << "Unknown view " << view << " (expected dijkstra, flow, astar or prim)" << endl;
+        return 1;
+    }
 
-        // Draw nodes
-        for (const auto& node : nodes) {
-            window.draw(node.shape);
-            window.draw(node.label);
+    bool written = exporter.finish();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    double video = double(exporter.frameCount()) / fps;
+    cout << "Exported " << exporter.frameCount() << " frames (" << fixed << setprecision(1) << video << " s at " << fps
+        << " fps) to " << path << " in " << elapsed << " s, " << video / max(elapsed, 1e-9) << "x real time\n"
+        << "At most " << exporter.peakFramesQueued() << " frames queued for the encoders; "
+        << exporter.stalledFrames() << " frames waited for room in the queue" << endl;
+    if (!written) {
+        cerr << "Some frames could not be written" << endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // --map file.map [--scen file.scen] loads a Moving AI map into the A* view;
+    // adding --bench runs the scenarios headlessly and prints the results.
+    // --export VIEW --out PATH records a run of one view without a window.
+    string mapPath, scenPath, exportView, exportPath;
+    bool bench = false;
+    unsigned fps = 30, nodeCount = 25, seed = 1;
+    Vector2u exportSize;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--map" && i + 1 < argc) mapPath = argv[++i];
+        else if (arg == "--scen" && i + 1 < argc) scenPath = argv[++i];
+        else if (arg == "--bench") bench = true;
+        else if (arg == "--export" && i + 1 < argc) exportView = argv[++i];
+        else if (arg == "--out" && i + 1 < argc) exportPath = argv[++i];
+        else if (arg == "--fps" && i + 1 < argc) fps = max(1, atoi(argv[++i]));
+        else if (arg == "--steps" && i + 1 < argc) timeline.stepsPerFrame = max(1, atoi(argv[++i]));
+        else if (arg == "--nodes" && i + 1 < argc) nodeCount = max(2, atoi(argv[++i]));
+        else if (arg == "--seed" && i + 1 < argc) seed = atoi(argv[++i]);
+        else if (arg == "--size" && i + 1 < argc && sscanf(argv[++i], "%ux%u", &exportSize.x, &exportSize.y) == 2) {}
+        else {
+            cerr << "Usage: " << argv[0] << " [--map file.map [--scen file.scen [--bench]]]\n"
+                << "       " << argv[0] << " --export dijkstra|flow|astar|prim --out DIR|FILE.y4m"
+                << " [--fps N] [--size WxH] [--steps N] [--nodes N] [--seed N] [--map file.map [--scen file.scen]]" << endl;
+            return 1;
         }
     }
-};
+    WallMap importedMap;
+    vector<Scenario> importedScenarios;
+    string error;
+    if (!mapPath.empty() && !loadMovingAIMap(mapPath, importedMap, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    if (!scenPath.empty() && (mapPath.empty() || !loadMovingAIScenarios(scenPath, importedMap, importedScenarios, error))) {
+        cerr << (mapPath.empty() ? "--scen needs a --map" : error) << endl;
+        return 1;
+    }
+    if (bench) {
+        if (importedScenarios.empty()) {
+            cerr << "--bench needs a --map and a non-empty --scen" << endl;
+            return 1;
+        }
+        cout << mapPath << "\n";
+        runScenarioBenchmark(importedMap, importedScenarios, cout);
+        return 0;
+    }
+    if (!exportView.empty())
+        return runExport(exportView, exportPath, fps, exportSize, nodeCount, seed, importedMap, importedScenarios);
 
-int main() {
     VideoMode desktop = VideoMode::getDesktopMode();
     RenderWindow window(desktop, "Algorithm Visualizer", Style::Fullscreen);
     window.setFramerateLimit(60);
@@ -1403,7 +7501,7 @@ int main() {
     FloatRect bgBounds = background.getGlobalBounds();
     background.setPosition((winSize.x - bgBounds.width) / 2.f, (winSize.y - bgBounds.height) / 2.f);
 
-    vector<string> labels = { "Dijkstra Algorithm", "Ford Fulkerson", "A*", "Prims MST Algorithm", "Exit" };
+    vector<string> labels = { "Dijkstra Algorithm", "Ford Fulkerson", "A*", "Prims MST Algorithm", "Compare Engines", "Exit" };
     vector<RectangleShape> buttons;
     vector<Text> texts;
 
@@ -1431,25 +7529,71 @@ int main() {
     Graph dijkstraGraph;
     InputBox dijkstraInput;
     AStarVisualizer astarVisualizer;
+    EngineComparison engineComparison;
+    if (!mapPath.empty()) {
+        engineComparison.loadMap(importedMap, importedScenarios);
+        astarVisualizer.loadMap(importedMap);
+        if (!importedScenarios.empty())
+            astarVisualizer.loadScenarios(move(importedScenarios));
+    }
     FordFulkersonVisualizer fordFulkersonVisualizer;
     PrimsVisualizer primsVisualizer;  // Added Prim's algorithm visualizer
 
-    // Set render window for Ford-Fulkerson
-    fordFulkersonVisualizer.setRenderWindow(window);
+    // Drawing happens on the render thread from here on
+    RenderThread renderer(window);
+    renderer.start();
+
+    PerfHud perfHud;
+    Clock frameClock;
+    Clock paceClock;
+    const Time framePeriod = seconds(1.f / 60.f);
+
+    // Render on demand: a frame is drawn only when a view reports a change, the
+    // active view or an overlay switched, or the window needs repainting. With
+    // nothing animating the loop sleeps in waitEvent instead of spinning.
+    bool needsFrame = true;
 
     while (window.isOpen()) {
         Event event;
-        Vector2f mousePos = window.mapPixelToCoords(Mouse::getPosition(window));
-
-        while (window.pollEvent(event)) {
-            if (event.type == Event::Closed)
+        bool animating = (currentState == VIEW1 && dijkstraGraph.isBusy()) ||
+            (currentState == VIEW2 && fordFulkersonVisualizer.isBusy()) ||
+            (currentState == VIEW3 && astarVisualizer.isBusy()) ||
+            (currentState == VIEW4 && primsVisualizer.isBusy()) ||
+            (currentState == VIEW5 && engineComparison.isBusy());
+        bool waited = false;
+        if (!needsFrame && !animating) {
+            TraceZone idleZone("Idle");
+            waited = window.waitEvent(event);
+        }
+        frameClock.restart();
+        AppState previousState = currentState;
+
+        TraceZone eventZone("Event handling");
+        while (waited || window.pollEvent(event)) {
+            waited = false;
+            Vector2f mousePos = window.mapPixelToCoords(Mouse::getPosition(window));
+            if (event.type == Event::Closed) {
+                renderer.stop();
                 window.close();
-
-            if (currentState == MENU && event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Left) {
+            }
+            if (event.type == Event::Resized || event.type == Event::GainedFocus)
+                needsFrame = true;
+
+            // The timeline under a view gets first look at clicks and arrow keys
+            ScrubBar* scrubBar = currentState == VIEW1 ? &dijkstraGraph.scrubber() :
+                currentState == VIEW2 ? &fordFulkersonVisualizer.scrubber() :
+                currentState == VIEW3 ? &astarVisualizer.scrubber() :
+                currentState == VIEW4 ? &primsVisualizer.scrubber() : nullptr;
+            if (scrubBar && scrubBar->handleEvent(event, mousePos)) {
+                // taken by the timeline
+            }
+            else if (currentState == MENU && event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Left) {
                 for (size_t i = 0; i < buttons.size(); ++i) {
                     if (buttons[i].getGlobalBounds().contains(mousePos)) {
-                        if (labels[i] == "Exit")
+                        if (labels[i] == "Exit") {
+                            renderer.stop();
                             window.close();
+                        }
                         else
                             currentState = static_cast<AppState>(i + 1);
                     }
@@ -1465,7 +7609,10 @@ int main() {
                         dijkstraInput.addChar(static_cast<char>(event.text.unicode));
                     }
                 }
-                if (event.type == Event::MouseButtonPressed) {
+                if (event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Right) {
+                    dijkstraGraph.togglePin(mousePos);
+                }
+                else if (event.type == Event::MouseButtonPressed) {
                     if (dijkstraGraph.isExitButtonClicked(mousePos)) {
                         currentState = MENU;
                     }
@@ -1478,7 +7625,17 @@ int main() {
                 }
             }
             else if (currentState == VIEW2) { // Ford-Fulkerson
-                if (!fordFulkersonVisualizer.isAnimating()) {
+                // Exit and Restart stay live while a run is in flight
+                if (event.type == Event::MouseButtonPressed && fordFulkersonVisualizer.isExitButtonClicked(mousePos)) {
+                    currentState = MENU;
+                }
+                else if (event.type == Event::MouseButtonPressed && fordFulkersonVisualizer.isRestartButtonClicked(mousePos)) {
+                    fordFulkersonVisualizer.reset();
+                }
+                else if (event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Right) {
+                    fordFulkersonVisualizer.togglePin(mousePos);
+                }
+                else if (!fordFulkersonVisualizer.isAnimating()) {
                     if (event.type == Event::TextEntered) {
                         if (event.text.unicode == '\r') {
                             fordFulkersonVisualizer.processEdgeInput();
@@ -1488,15 +7645,7 @@ int main() {
                         }
                     }
                     if (event.type == Event::MouseButtonPressed) {
-                        if (fordFulkersonVisualizer.isExitButtonClicked(mousePos)) {
-                            currentState = MENU;
-                        }
-                        else if (fordFulkersonVisualizer.isRestartButtonClicked(mousePos)) {
-                            fordFulkersonVisualizer.reset();
-                        }
-                        else {
-                            fordFulkersonVisualizer.handleClick(mousePos);
-                        }
+                        fordFulkersonVisualizer.handleClick(mousePos);
                     }
                 }
             }
@@ -1516,6 +7665,26 @@ int main() {
 
                 if (event.type == Event::KeyPressed && event.key.code == Keyboard::Space)
                     astarVisualizer.runAStar();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::H)
+                    astarVisualizer.runHierarchical();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::O)
+                    astarVisualizer.toggleClusterOverlay();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::M) {
+                    if (event.key.shift) astarVisualizer.runAgentsToGoal();
+                    else astarVisualizer.runAgents();
+                }
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::D)
+                    astarVisualizer.toggleDistanceField();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::C)
+                    astarVisualizer.toggleComponentOverlay();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::N)
+                    astarVisualizer.showNextScenario();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::T)
+                    astarVisualizer.cycleBrush();
+                if (event.type == Event::KeyPressed && event.key.code == Keyboard::G)
+                    astarVisualizer.cycleMovement();
+                if (event.type == Event::MouseMoved && Mouse::isButtonPressed(Mouse::Left))
+                    astarVisualizer.paintTerrain(mousePos);
             }
             // Added handling for VIEW4 - Prim's MST Algorithm
             else if (currentState == VIEW4) {
@@ -1523,7 +7692,10 @@ int main() {
                     primsVisualizer.handleTextInput(event.text.unicode);
                 }
 
-                if (event.type == Event::MouseButtonPressed) {
+                if (event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Right) {
+                    primsVisualizer.togglePin(mousePos);
+                }
+                else if (event.type == Event::MouseButtonPressed) {
                     if (primsVisualizer.isExitButtonClicked(mousePos)) {
                         currentState = MENU;
                     }
@@ -1535,46 +7707,124 @@ int main() {
                     }
                 }
             }
+            else if (currentState == VIEW5) {
+                if (event.type == Event::MouseButtonPressed) {
+                    if (engineComparison.isExitButtonClicked(mousePos)) {
+                        currentState = MENU;
+                    }
+                    else if (engineComparison.isRestartButtonClicked(mousePos)) {
+                        engineComparison.reset();
+                    }
+                    else {
+                        engineComparison.handleClick(mousePos);
+                    }
+                }
+                if (event.type == Event::KeyPressed)
+                    engineComparison.handleKey(event.key.code);
+            }
 
             if (event.type == Event::KeyPressed && event.key.code == Keyboard::Escape)
                 currentState = MENU;
+            if (event.type == Event::KeyPressed && event.key.code == Keyboard::F6) {
+                if (currentState == VIEW1) dijkstraGraph.toggleLayout();
+                else if (currentState == VIEW2) fordFulkersonVisualizer.toggleLayout();
+                else if (currentState == VIEW4) primsVisualizer.toggleLayout();
+            }
+            if (event.type == Event::KeyPressed && event.key.code == Keyboard::F3) {
+                perfHud.toggle();
+                needsFrame = true;
+            }
+            if (event.type == Event::KeyPressed && event.key.code == Keyboard::F4) {
+                char name[64];
+                time_t now = time(nullptr);
+                strftime(name, sizeof(name), "trace-%Y%m%d-%H%M%S.json", localtime(&now));
+                if (tracer.dump(name))
+                    cout << "Trace written to " << name << endl;
+            }
         }
+        eventZone.end();
 
         // Handle algorithm updates
+        TraceZone updateZone("update");
         if (currentState == VIEW1) {
             dijkstraGraph.update();
         }
+        else if (currentState == VIEW2) {
+            fordFulkersonVisualizer.update();
+        }
+        else if (currentState == VIEW3) {
+            astarVisualizer.update();
+        }
         else if (currentState == VIEW4) {
             // Update Prim's algorithm animation
             primsVisualizer.update();
         }
+        else if (currentState == VIEW5) {
+            engineComparison.update();
+        }
+        updateZone.end();
+
+        if (currentState != previousState) {
+            needsFrame = true;
+            // Leaving a view abandons whatever it was computing
+            if (previousState == VIEW1) dijkstraGraph.cancelRun();
+            else if (previousState == VIEW2) fordFulkersonVisualizer.cancelRun();
+            else if (previousState == VIEW3) astarVisualizer.cancelRun();
+            else if (previousState == VIEW4) primsVisualizer.cancelRun();
+            else if (previousState == VIEW5) engineComparison.cancelRun();
+        }
+        if (currentState == VIEW1) needsFrame |= dijkstraGraph.consumeDirty() | dijkstraInput.consumeDirty();
+        else if (currentState == VIEW2) needsFrame |= fordFulkersonVisualizer.consumeDirty();
+        else if (currentState == VIEW3) needsFrame |= astarVisualizer.consumeDirty();
+        else if (currentState == VIEW4) needsFrame |= primsVisualizer.consumeDirty();
+        else if (currentState == VIEW5) needsFrame |= engineComparison.consumeDirty();
+        if (!needsFrame) {
+            if (animating)
+                sleep(milliseconds(5)); // animation waiting for its next step
+            continue;
+        }
+        needsFrame = false;
 
-        // Drawing logic
-        window.clear(Color(30, 30, 30));
+        // Drawing logic: record a snapshot for the render thread
+        TraceZone drawZone("record");
+        Canvas canvas(renderer.beginFrame());
 
         if (currentState == MENU) {
-            window.draw(background);
+            canvas.draw(background);
             for (size_t i = 0; i < buttons.size(); ++i) {
-                window.draw(buttons[i]);
-                window.draw(texts[i]);
+                canvas.draw(buttons[i]);
+                canvas.draw(texts[i]);
             }
         }
         else if (currentState == VIEW1) {
-            dijkstraGraph.draw(window);
-            dijkstraInput.draw(window);
+            dijkstraGraph.draw(canvas);
+            dijkstraInput.draw(canvas);
         }
         else if (currentState == VIEW2) {
-            fordFulkersonVisualizer.draw(window);
+            fordFulkersonVisualizer.draw(canvas);
         }
         else if (currentState == VIEW3) {
-            astarVisualizer.draw(window);
+            astarVisualizer.draw(canvas);
         }
         else if (currentState == VIEW4) {
             // Draw MST algorithm interface
-            primsVisualizer.draw(window);
+            primsVisualizer.draw(canvas);
+        }
+        else if (currentState == VIEW5) {
+            engineComparison.draw(canvas);
         }
 
-        window.display();
+        if (currentState != MENU)
+            perfHud.draw(canvas);
+        renderer.submit();
+        drawZone.end();
+        perfHud.recordFrame(frameClock.getElapsedTime().asSeconds() * 1000.f, canvas.drawCalls);
+
+        // Produce at most one snapshot per display refresh
+        Time left = framePeriod - paceClock.getElapsedTime();
+        if (left > Time::Zero)
+            sleep(left);
+        paceClock.restart();
     }
 
     return 0;